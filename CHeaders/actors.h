@@ -1,20 +1,35 @@
-#ifndef ACTORS_H
-#define ACTORS_H
-
-#include <stddef.h>
-
-typedef struct {
-    int codice; // Codice dell'attore
-    char* nome; // Nome dell'attore
-    int anno; // Anno di nascita dell'attore
-    int numcop; // Numero dei coprotagonisti dell'attore
-    int* cop; // Array contenente i codici dei coprotagonisti dell'attore
-} attore;
-
-attore** createActors(char*, size_t*);
-void freeAttori(attore**, size_t);
-int compareAttore(const void*, const void*);
-char* actorToString(attore*);
-void printActors(attore**, size_t);
-
+#ifndef ACTORS_H
+#define ACTORS_H
+
+#include "arena.h"
+
+#include <stddef.h>
+
+typedef struct {
+    int codice; // Codice dell'attore
+    char* nome; // Nome dell'attore (punta al pool dei nomi del grafo dopo la costruzione del grafo CSR)
+    int anno; // Anno di nascita dell'attore
+    int numcop; // Numero dei coprotagonisti dell'attore
+    int* cop; // Array contenente i codici dei coprotagonisti dell'attore (NULL dopo la costruzione del grafo CSR)
+} attore;
+
+typedef struct {
+    attore** attori; // Array dei puntatori agli attori, nell'ordine di nomi.txt
+    size_t size; // Numero di attori
+    char* nomi; // Pool contiguo dei nomi terminati da '\0'
+    size_t dimensioneNomi; // Byte usati del pool dei nomi
+} tabellaAttori;
+
+typedef struct {
+    const char* start; // Inizio del blocco di nomi.txt assegnato al thread
+    const char* end; // Fine (esclusa) del blocco
+    attore* attori; // Porzione dell'array contiguo degli attori riservata al blocco
+    char* nomi; // Porzione del pool dei nomi riservata al blocco
+    size_t count; // Numero di attori letti dal blocco
+    size_t nomiUsati; // Byte del pool dei nomi usati dal blocco
+} actorsWorkerData;
+
+void* actorsWorkerBody(void*);
+void loadActors(char*, size_t, arena*, tabellaAttori*);
+
 #endif
\ No newline at end of file
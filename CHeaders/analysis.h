@@ -0,0 +1,49 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include "graph.h"
+#include "options.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h> // Per clock_t
+
+#define ANALYSIS_WIDTH 64 // Sorgenti visitate insieme da una sweep, una per bit di una parola a 64 bit
+#define ANALYSIS_HISTOGRAM_FILE "separazione.tsv" // Istogramma dei gradi di separazione
+#define ANALYSIS_ECCENTRICITY_FILE "eccentricita.tsv" // Eccentricità di ogni nodo
+#define ANALYSIS_PROGRESS_SECONDS 1 // Intervallo minimo tra due stampe dell'avanzamento
+#define ANALYSIS_EFFECTIVE_PERCENTILE 0.9 // Percentile delle coppie connesse usato per il diametro efficace
+
+typedef struct {
+    grafo* g; // Grafo degli attori
+    int* sorgenti; // Id densi delle sorgenti, tutti i nodi nell'analisi esatta
+    size_t numSorgenti; // Numero di sorgenti
+    size_t prossimoLotto; // Primo lotto di ANALYSIS_WIDTH sorgenti non ancora assegnato ad un worker
+    size_t sorgentiCompletate; // Sorgenti dei lotti di cui è terminata la visita
+    uint32_t* eccentricita; // Massima distanza di ogni nodo dalle sorgenti che lo raggiungono, aggiornata con massimo atomico
+    bool* esatta; // true se l'eccentricità del nodo è esatta (il nodo è una sorgente o l'analisi è esatta)
+    uint64_t* istogramma; // istogramma[d] coppie ordinate (sorgente, nodo) a distanza d, unione di quelli dei worker
+    size_t dimensioneIstogramma; // Numero di elementi di istogramma
+    uint64_t archiEsaminati; // Archi esaminati da tutte le visite, per il throughput
+    clock_t inizio; // Istante di inizio dell'analisi
+    clock_t ultimaStampa; // Istante dell'ultima stampa dell'avanzamento
+    volatile bool* mustShutdown; // Impostato dal thread gestore dei segnali all'arrivo di SIGINT
+    pthread_mutex_t mutex; // Mutex per i lotti, l'avanzamento e l'istogramma
+} analysisState;
+
+typedef struct {
+    uint64_t* seen; // seen[v] ha il bit s acceso se il nodo v è stato raggiunto dalla sorgente s
+    uint64_t* visit; // Frontiera corrente
+    uint64_t* visitNext; // Frontiera del livello successivo
+    uint64_t* istogramma; // Istogramma locale del worker
+    size_t dimensioneIstogramma; // Numero di elementi dell'istogramma locale
+    uint64_t archiEsaminati; // Archi esaminati dal worker
+} analysisWorker;
+
+void runAnalysis(grafo*, const opzioni*, volatile bool*);
+void* analysisWorkerBody(void*);
+int* chooseSources(size_t, size_t, size_t*);
+
+#endif
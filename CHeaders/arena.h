@@ -0,0 +1,27 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_SIZE (1 << 20) // Size minima di un blocco dell'arena (1 MiB)
+#define ARENA_ALIGNMENT 16 // Allineamento di ogni allocazione
+
+typedef struct arenaBlock {
+    struct arenaBlock* next; // Blocco allocato in precedenza
+    size_t capacity; // Byte utilizzabili del blocco
+    size_t used; // Byte già assegnati
+    size_t last; // Posizione dell'ultima allocazione, per arenaTrim()
+} arenaBlock;
+
+typedef struct {
+    arenaBlock* current; // Blocco da cui vengono assegnate le allocazioni
+    size_t allocated; // Byte totali richiesti al sistema
+} arena;
+
+arena* arenaCreate();
+void* arenaAlloc(arena*, size_t);
+void* arenaCalloc(arena*, size_t, size_t);
+void arenaTrim(arena*, void*, size_t);
+void arenaFree(arena*);
+
+#endif
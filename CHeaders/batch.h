@@ -0,0 +1,44 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "graph.h"
+#include "options.h"
+#include "components.h"
+#include "responses.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#define BATCH_MEMORY_BUDGET ((size_t) 256 << 20) // Memoria massima per i contesti di ricerca di tutti i worker del batch
+
+typedef struct {
+    int32_t a; // Codice dell'attore iniziale
+    int32_t b; // Codice dell'attore destinazione
+    int idA; // Id denso di a
+    int idB; // Id denso di b
+} batchQuery;
+
+typedef struct {
+    size_t first; // Indice della prima richiesta del lotto (richieste ordinate per sorgente)
+    size_t last; // Indice successivo all'ultima richiesta del lotto
+    size_t numSources; // Sorgenti distinte del lotto, al più MSBFS_WIDTH
+} batchLot;
+
+typedef struct {
+    grafo* g; // Grafo degli attori
+    const opzioni* opts; // Opzioni passate da linea di comando
+    responseChannel* risposte; // Pipe delle risposte (NULL se le risposte vanno nei file a.b)
+    batchQuery* queries; // Richieste valide ordinate per sorgente
+    batchLot* lots; // Lotti di richieste
+    size_t numLots; // Numero di lotti
+    size_t nextLot; // Primo lotto non ancora assegnato ad un worker
+    volatile bool* mustShutdown; // Impostato dal thread gestore dei segnali all'arrivo di SIGINT
+    pthread_mutex_t mutex; // Mutex per nextLot
+} batchState;
+
+void runBatch(grafo*, const componentIndex*, responseChannel*, const opzioni*, volatile bool*);
+void* batchWorkerBody(void*);
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef BFS_H
+#define BFS_H
+
+#include "graph.h"
+#include "dataStructures.h"
+#include "landmarks.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum {
+    BFS_UNIDIREZIONALE, // BFS classica da a verso b
+    BFS_BIDIREZIONALE, // BFS alternata da a e da b, espande sempre la frontiera più piccola
+    BFS_DIREZIONALE, // BFS direction-optimizing, alterna passi top-down e bottom-up
+    BFS_ASTAR // Ricerca A* guidata dai limiti inferiori dei landmark
+} bfsMode;
+
+// Soglie di cambio direzione della BFS direction-optimizing (Beamer et al.)
+#define BFS_ALPHA 14 // Passa a bottom-up quando gli archi della frontiera superano archiNonEsplorati / ALPHA
+#define BFS_BETA 24 // Torna a top-down quando i nodi della frontiera sono meno di numNodi / BETA
+
+typedef struct {
+    int annoMin; // Anno di nascita minimo dei nodi intermedi
+    int annoMax; // Anno di nascita massimo dei nodi intermedi
+} yearFilter;
+
+typedef struct {
+    size_t distanza; // Archi dei cammini minimi, valida solo se numCammini > 0
+    int livelloAvanti; // Livello della frontiera di start quando i due lati si sono incontrati
+    uint64_t numCammini; // Numero di cammini minimi da start a target, 0 se non esistono
+    bool saturo; // true se numCammini ha superato UINT64_MAX ed è stato saturato
+    size_t numIncontri; // Archi di incontro memorizzati, bastano per enumerare i primi maxCammini cammini
+    size_t incontro; // Arco di incontro del cammino in enumerazione
+    bool iniziato; // false fino alla prima chiamata di bfsNextPath()
+} pathEnumerator;
+
+typedef struct {
+    uint32_t* visited; // visited[i] == epoch (lato di a) o epoch + 1 (lato di b) se il nodo i è stato visitato
+    uint32_t epoch; // Epoca della ricerca corrente, sempre pari
+    int* parents; // Array dei genitori indicizzato per id denso
+    int* successors; // Nodo successivo verso b, usato dal lato di b della ricerca bidirezionale
+    int* path; // Cammino da start a target estratto con bfsExtractPath()
+    circularQueue* queue; // Coda di ricerca
+    circularQueue* queueBackward; // Coda di ricerca del lato di b
+    uint64_t* frontier; // Bitmap della frontiera corrente nei passi bottom-up
+    uint64_t* nextFrontier; // Bitmap della frontiera successiva nei passi bottom-up
+    int* depth; // Distanza da start dei nodi scoperti dalla ricerca A*
+    circularQueue* buckets[3]; // Code della ricerca A* per valore di f modulo 3
+    const landmarkIndex* landmarks; // Indice dei landmark per la ricerca A* (NULL se non disponibile)
+    textBuffer* output; // Testo della risposta, formattato senza allocazioni per query e scritto con una sola write()
+    uint64_t* sigma; // Numero di cammini minimi verso ogni nodo dal suo lato (NULL fino alla prima bfsCountPaths())
+    size_t* cursors; // Posizione nei vicini per ogni nodo del cammino in enumerazione (NULL fino alla prima bfsCountPaths())
+    int* meetings; // Coppie (nodo di start, nodo di target) degli archi di incontro memorizzati da bfsCountPaths()
+    size_t meetingsCapacity; // Coppie che entrano in meetings
+    size_t size; // Numero di nodi per cui è dimensionato il contesto
+} bfsContext;
+
+bfsContext* bfsContextCreate(size_t);
+size_t bfsContextBytes(size_t);
+void bfsContextFree(bfsContext*);
+void bfsNewSearch(bfsContext*);
+bool bfsShortestPath(grafo*, bfsContext*, int, int);
+bool bfsBidirectional(grafo*, bfsContext*, int, int);
+bool bfsDirectionOptimizing(grafo*, bfsContext*, int, int);
+bool bfsAStar(grafo*, bfsContext*, int, int);
+bool findShortestPath(grafo*, bfsContext*, int, int, bfsMode);
+size_t bfsExtractPath(bfsContext*, int);
+void bfsFullTree(grafo*, bfsContext*, int);
+bool bfsConstrainedPath(grafo*, bfsContext*, int, int, const yearFilter*);
+bool bfsCountPaths(grafo*, bfsContext*, int, int, const yearFilter*, size_t, pathEnumerator*);
+size_t bfsNextPath(grafo*, bfsContext*, pathEnumerator*);
+void bfsRewindPaths(pathEnumerator*);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef CENTRALITY_H
+#define CENTRALITY_H
+
+#include "graph.h"
+#include "options.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h> // Per clock_t
+
+#define CENTRALITY_LOT 16 // Sorgenti prelevate da un worker ad ogni accesso alla zona critica
+#define CENTRALITY_FILE "centralita.tsv" // Classifica degli attori per centralità
+#define CENTRALITY_PROGRESS_SECONDS 1 // Intervallo minimo tra due stampe dell'avanzamento
+#define CENTRALITY_TOP 10 // Attori stampati su stderr alla fine del calcolo
+
+typedef struct {
+    grafo* g; // Grafo degli attori
+    int* sorgenti; // Id densi delle sorgenti, tutti i nodi nel calcolo esatto
+    size_t numSorgenti; // Numero di sorgenti
+    bool* sorgente; // sorgente[v] true se v è tra le sorgenti, per la closeness campionata
+    size_t prossimaSorgente; // Prima sorgente non ancora assegnata ad un worker
+    size_t sorgentiCompletate; // Sorgenti di cui è terminata la visita
+    double* betweenness; // Dipendenze accumulate da tutte le sorgenti, unione di quelle dei worker
+    uint64_t* sommaDistanze; // Somma delle distanze dalle sorgenti che raggiungono il nodo
+    uint32_t* raggiunto; // Numero di sorgenti diverse dal nodo che lo raggiungono
+    uint64_t archiEsaminati; // Archi esaminati da tutte le visite, per il throughput
+    clock_t inizio; // Istante di inizio del calcolo
+    clock_t ultimaStampa; // Istante dell'ultima stampa dell'avanzamento
+    volatile bool* mustShutdown; // Impostato dal thread gestore dei segnali all'arrivo di SIGINT
+    pthread_mutex_t mutex; // Mutex per le sorgenti, l'avanzamento e l'unione degli accumulatori
+} centralityState;
+
+typedef struct {
+    int* distanze; // Distanza dalla sorgente corrente, -1 se non raggiunto
+    double* sigma; // Numero di cammini minimi dalla sorgente corrente
+    double* delta; // Dipendenza della sorgente corrente da ogni nodo
+    int* ordine; // Nodi in ordine di visita: coda della BFS e poi pila della fase all'indietro
+    double* betweenness; // Accumulatore locale del worker
+    uint64_t* sommaDistanze; // Accumulatore locale del worker
+    uint32_t* raggiunto; // Accumulatore locale del worker
+    uint64_t archiEsaminati; // Archi esaminati dal worker
+} centralityWorker;
+
+void runCentrality(grafo*, const opzioni*, volatile bool*);
+void* centralityWorkerBody(void*);
+
+#endif
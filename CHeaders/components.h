@@ -0,0 +1,30 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include "graph.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#define COMPONENTS_HISTOGRAM 32 // Classi dell'istogramma delle dimensioni, una per potenza di 2
+
+typedef struct {
+    size_t numNodi; // Numero di nodi del grafo
+    int* etichette; // etichette[v] componente connessa del nodo v, numerate in ordine del loro nodo minimo
+    size_t* dimensioni; // dimensioni[c] numero di nodi della componente c
+    size_t numComponenti; // Numero di componenti connesse
+} componentIndex;
+
+typedef struct {
+    grafo* g; // Grafo degli attori
+    int* padri; // Foresta union-find condivisa, aggiornata solo con compare-and-swap
+    size_t start; // Primo nodo assegnato al thread
+    size_t end; // Nodo successivo all'ultimo assegnato al thread
+} componentsWorkerData;
+
+componentIndex* componentsBuild(grafo*, size_t);
+bool componentsConnected(const componentIndex*, int, int);
+void componentsReport(const componentIndex*, double);
+void componentsFree(componentIndex*);
+
+#endif
@@ -1,59 +1,47 @@
-#ifndef DATASTRUCTURES_H
-#define DATASTRUCTURES_H
-
-#include "actors.h"
-#include <stdbool.h>
-
-// =============================== ABR =============================== //
-
-typedef struct abr_node {
-    int shuffledCode;
-    struct abr_node* left;
-    struct abr_node* right;
-} abr;
-
-bool abrContains(abr*, int);
-void abrAdd(abr*, int);
-void abrFree(abr*);
-void abrFreeHelper(abr*);
-int shuffle(int);
-int unshuffle(int);
-
-// =============================== CIRCULAR QUEUE =============================== //
-
-#define INITIAL_QUEUE_SIZE 250000
-
-typedef struct {
-    int head; // Indice del primo elemento
-    int tail; // Indice dell'ultimo elemento
-    size_t size; // Numero di elementi nella coda
-    size_t capacity; // Capacità massima della coda
-    int* items;
-} circularQueue;
-
-circularQueue* queueCreate();
-bool queueIsFull(circularQueue*);
-bool queueIsEmpty(circularQueue*);
-void resizeQueue(circularQueue*);
-void enqueue(circularQueue*, int);
-int dequeue(circularQueue*);
-void freeQueue(circularQueue*);
-
-// =============================== STACK =============================== //
-
-typedef struct stack_node {
-    attore* actor;
-    struct stack_node* previous;
-} stack_node;
-
-typedef struct {
-    stack_node* top;
-} stack;
-
-stack* stackCreate();
-bool stackIsEmpty(stack*);
-void stackPush(stack*, attore*);
-attore* stackPop(stack*);
-void stackFree(stack*);
-
+#ifndef DATASTRUCTURES_H
+#define DATASTRUCTURES_H
+
+#include "actors.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// =============================== CIRCULAR QUEUE =============================== //
+
+#define INITIAL_QUEUE_SIZE 250000
+
+typedef struct {
+    int head; // Indice del primo elemento
+    int tail; // Indice dell'ultimo elemento
+    size_t size; // Numero di elementi nella coda
+    size_t capacity; // Capacità massima della coda
+    int* items;
+} circularQueue;
+
+circularQueue* queueCreate();
+void queueClear(circularQueue*);
+bool queueIsFull(circularQueue*);
+bool queueIsEmpty(circularQueue*);
+void resizeQueue(circularQueue*);
+void enqueue(circularQueue*, int);
+int dequeue(circularQueue*);
+void freeQueue(circularQueue*);
+
+// =============================== TEXT BUFFER =============================== //
+
+#define INITIAL_TEXT_BUFFER_SIZE 4096
+
+typedef struct {
+    char* data; // Testo accumulato, non terminato da '\0'
+    size_t size; // Numero di byte di testo
+    size_t capacity; // Byte allocati
+} textBuffer;
+
+textBuffer* textBufferCreate();
+void textBufferClear(textBuffer*);
+void textBufferReserve(textBuffer*, size_t);
+void textBufferAppend(textBuffer*, const char*, size_t);
+void textBufferAppendString(textBuffer*, const char*);
+void textBufferAppendInt(textBuffer*, long long);
+void freeTextBuffer(textBuffer*);
+
 #endif
\ No newline at end of file
@@ -1,24 +1,51 @@
-#ifndef GRAPH_H
-#define GRAPH_H
-
-#include "actors.h"
-#include <stdio.h>
-#include <semaphore.h>
-#include <pthread.h>
-
-typedef struct {
-    char** buffer; // Buffer produttore/consumatori
-    int* index; // Indice dei consumatori
-    pthread_mutex_t* mutex; // Mutex dei consumatori
-    sem_t* freeSlots; // Semaforo degli elementi liberi
-    sem_t* itemsIn; // Semaforo degli elementi occupati
-    attore** attori; // Array degli attori
-    int attoriSize; // Size dell'array degli attori
-} workerData;
-
-void updateCoprotagonists(char*, attore**, size_t);
-void* workerBody(void*);
-void producerBody(FILE*, char**, sem_t*, sem_t*, size_t);
-void processGraph(char*, size_t, attore**, size_t);
-
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include "actors.h"
+#include "arena.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+typedef struct {
+    attore** attori; // Array degli attori ordinato per codice, la posizione di un attore è il suo id denso (NULL se caricato da snapshot)
+    arena* memoria; // Arena da cui provengono il grafo, gli attori, i nomi e gli array (NULL se caricato da snapshot)
+    size_t numNodi; // Numero di nodi del grafo (size dell'array degli attori)
+    size_t numArchi; // Numero di elementi dell'array vicini
+    size_t* offsets; // I vicini del nodo i sono vicini[offsets[i]] ... vicini[offsets[i + 1] - 1]
+    int* vicini; // Array contiguo degli id densi dei vicini di tutti i nodi
+    int* codici; // Tabella id denso -> codice IMDb, usata solo per l'input e l'output
+    int* anni; // Anno di nascita di ogni nodo
+    size_t* nomiOffsets; // Il nome del nodo i inizia in nomi[nomiOffsets[i]]
+    char* nomi; // Pool contiguo dei nomi terminati da '\0'
+    size_t dimensioneNomi; // Numero di byte del pool dei nomi
+    void* mappa; // Snapshot mappato in memoria da cui provengono gli array (NULL se caricato da file di testo)
+    size_t dimensioneMappa; // Size della mappatura dello snapshot
+} grafo;
+
+typedef struct {
+    int codice; // Codice dell'attore della linea
+    int numcop; // Numero di coprotagonisti dichiarato
+    int id; // Id denso dell'attore, calcolato dopo la lettura di nomi.txt
+    const char* cop; // Inizio della lista dei coprotagonisti nel file mappato
+    const char* end; // Fine (esclusa) della linea
+} lineRecord;
+
+typedef struct {
+    const char* start; // Inizio del blocco di grafo.txt assegnato al thread
+    const char* end; // Fine (esclusa) del blocco
+    grafo* g; // Grafo in costruzione nel secondo passo, NULL nel primo
+    lineRecord* records; // Record delle linee del blocco, riempiti nel primo passo
+    size_t numRecords; // Numero di record del blocco
+} workerData;
+
+void countCoprotagonists(const char*, const char*, lineRecord*);
+void updateCoprotagonists(const lineRecord*, grafo*);
+void* workerBody(void*);
+grafo* processGraph(char*, char*, size_t);
+grafo* createGraph(tabellaAttori*, arena*);
+int nodeIndex(grafo*, int);
+char* nodeName(grafo*, int);
+void freeGrafo(grafo*);
+
 #endif
\ No newline at end of file
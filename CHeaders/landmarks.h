@@ -0,0 +1,52 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include "graph.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define LANDMARK_MAGIC "LANDMRK" // 7 caratteri + '\0' = 8 byte
+#define LANDMARK_VERSION 1
+#define LANDMARK_MAX 64 // Massimo numero di landmark, calcolati con al più due BFS multi-sorgente
+#define LANDMARK_INF 255 // Distanza dei nodi non raggiungibili da un landmark
+#define LANDMARK_SAMPLE_PAIRS 200 // Coppie casuali usate per misurare l'accuratezza dei limiti
+#define LANDMARK_NO_PATH INT32_MAX // Limite inferiore di due nodi in componenti diverse
+
+/*
+    Formato del file dei landmark (little endian):
+        header | distanze (uint8[numNodi][k]), la riga di un nodo contiene le distanze da tutti i landmark
+*/
+typedef struct {
+    char magic[8]; // LANDMARK_MAGIC
+    uint32_t versione; // LANDMARK_VERSION
+    uint32_t k; // Numero di landmark
+    uint64_t numNodi; // Nodi del grafo per cui è stato calcolato l'indice
+    uint64_t numArchi; // Archi del grafo per cui è stato calcolato l'indice
+    uint32_t saturo; // 1 se qualche distanza supera LANDMARK_INF - 1
+    int32_t landmarks[LANDMARK_MAX]; // Id densi dei landmark
+} landmarkHeader;
+
+typedef struct {
+    size_t k; // Numero di landmark
+    size_t numNodi; // Numero di nodi del grafo
+    int landmarks[LANDMARK_MAX]; // Id densi dei landmark
+    uint8_t* dist; // dist[v * k + l] distanza del nodo v dal landmark l, LANDMARK_INF se non raggiungibile
+    bool saturo; // true se qualche distanza raggiungibile non è memorizzabile, i limiti non sono più garantiti
+    void* mappa; // File mappato da cui proviene dist (NULL se calcolato)
+    size_t dimensioneMappa; // Size della mappatura
+} landmarkIndex;
+
+landmarkIndex* landmarkBuild(grafo*, size_t);
+landmarkIndex* landmarkLoad(grafo*, const char*, size_t);
+void landmarkSave(landmarkIndex*, grafo*, const char*);
+bool landmarkIsUsable(const char*, const char*, const char*, const char*);
+void landmarkBounds(const landmarkIndex*, int, int, int*, int*);
+size_t landmarkPath(grafo*, const landmarkIndex*, int, int, int*);
+int landmarkHeuristic(const landmarkIndex*, int, const uint8_t*);
+void landmarkReport(grafo*, const landmarkIndex*, double);
+landmarkIndex* landmarkPrepare(grafo*, size_t, const char*, const char*, const char*);
+void landmarkFree(landmarkIndex*);
+
+#endif
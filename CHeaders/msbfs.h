@@ -0,0 +1,36 @@
+#ifndef MSBFS_H
+#define MSBFS_H
+
+#include "graph.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define MSBFS_WIDTH 64 // Sorgenti visitate insieme, una per bit di una parola a 64 bit
+#define MSBFS_UNREACHED 255 // Distanza dei nodi non raggiunti (o raggiunti oltre MSBFS_MAX_LEVEL)
+#define MSBFS_MAX_LEVEL 254 // Massima distanza memorizzabile in un uint8_t
+
+typedef struct {
+    int source; // Indice della sorgente nel lotto (bit della parola)
+    int node; // Id denso del nodo da raggiungere
+} msbfsTarget;
+
+typedef struct {
+    size_t n; // Numero di nodi per cui è dimensionato il contesto
+    uint64_t* seen; // seen[v] ha il bit s acceso se il nodo v è stato raggiunto dalla sorgente s
+    uint64_t* visit; // Frontiera corrente: bit s acceso se v è nella frontiera della sorgente s
+    uint64_t* visitNext; // Frontiera del livello successivo
+    uint8_t* dist; // dist[s * n + v] distanza di v dalla sorgente s, MSBFS_UNREACHED se non raggiunto
+    size_t levels; // Livelli espansi dall'ultima visita
+} msbfsContext;
+
+msbfsContext* msbfsContextCreate(size_t);
+size_t msbfsContextBytes(size_t);
+void msbfsContextFree(msbfsContext*);
+void msbfsRun(grafo*, msbfsContext*, const int*, size_t, const msbfsTarget*, size_t);
+bool msbfsReached(msbfsContext*, int, int);
+uint8_t msbfsDistance(msbfsContext*, int, int);
+size_t msbfsExtractPath(grafo*, msbfsContext*, int, int, int*);
+
+#endif
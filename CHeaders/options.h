@@ -0,0 +1,42 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "bfs.h"
+#include "pathCache.h"
+#include "responses.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define DEFAULT_JOB_QUEUE_SIZE 1024
+#define DEFAULT_PIPE "cammini.pipe" // Named pipe usata se non viene passato --pipe
+#define MAX_PIPES 16 // Massimo numero di named pipe servite contemporaneamente
+#define MAX_K_CAMMINI 10000 // Massimo numero di cammini minimi scritti per richiesta con --k-cammini
+
+typedef struct {
+    char* fileNomi; // Percorso di nomi.txt (NULL se il grafo viene caricato solo dallo snapshot)
+    char* fileGrafo; // Percorso di grafo.txt (NULL se il grafo viene caricato solo dallo snapshot)
+    size_t numConsumatori; // Numero di thread consumatori per la lettura di grafo.txt
+    char* snapshot; // Percorso dello snapshot binario del grafo (--snapshot=)
+    bfsMode modalitaRicerca; // Algoritmo usato per i cammini minimi (--bfs=)
+    size_t numThread; // Numero di thread del pool per i cammini minimi (--thread=)
+    size_t dimensioneCoda; // Capacità della coda dei lavori del pool (--coda=)
+    size_t memoriaCacheCammini; // Byte massimi della cache dei cammini, 0 se disabilitata (--cache-cammini=, in MB)
+    size_t numAlberi; // Numero massimo di alberi BFS memorizzati, 0 se disabilitata (--cache-alberi=)
+    size_t numCammini; // Cammini minimi distinti scritti per ogni richiesta, 0 per uno solo senza conteggio (--k-cammini=)
+    char* fileBatch; // File di coppie da risolvere in modalità batch, NULL per la modalità pipe (--batch=)
+    size_t numLandmark; // Numero di landmark dell'indice delle distanze, 0 se disabilitato (--landmark=)
+    char* pipes[MAX_PIPES]; // Named pipe da cui leggere le richieste (--pipe=, ripetibile)
+    size_t numPipe; // Numero di named pipe, DEFAULT_PIPE se non viene passato --pipe
+    char* fileRisposte; // Named pipe su cui scrivere le risposte, NULL per i file a.b (--risposte=)
+    formatoRisposte formatoRisposte; // Formato dei record sulla pipe delle risposte (--formato-risposte=)
+    bool analisi; // Modalità analisi: istogramma dei gradi di separazione ed eccentricità, poi termina (--analisi)
+    bool centralita; // Modalità centralità: classifica per betweenness e closeness, poi termina (--centralita)
+    size_t numCampioni; // Sorgenti campionate dall'analisi e dalla centralità, 0 per usare tutti i nodi (--campioni=)
+} opzioni;
+
+void defaultOptions(opzioni*);
+bool parseOption(char*, opzioni*);
+void printUsage(const char*);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef PATHCACHE_H
+#define PATHCACHE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#define DEFAULT_PATH_CACHE_MB 64 // Memoria massima di default della cache dei cammini
+
+typedef struct cacheEntry {
+    int a; // Id denso minore della coppia
+    int b; // Id denso maggiore della coppia
+    size_t length; // Numero di nodi del cammino da a a b, 0 se il cammino non esiste
+    struct cacheEntry* hashNext; // Voce successiva nella stessa lista di trabocco
+    struct cacheEntry* newer; // Voce usata più recentemente nella lista LRU
+    struct cacheEntry* older; // Voce usata meno recentemente nella lista LRU
+    int nodes[]; // Id densi del cammino da a a b
+} cacheEntry;
+
+typedef struct {
+    cacheEntry** buckets; // Tabella hash con liste di trabocco
+    size_t numBuckets; // Numero di liste, potenza di 2
+    cacheEntry* newest; // Testa della lista LRU
+    cacheEntry* oldest; // Coda della lista LRU, la prima ad essere eliminata
+    size_t memory; // Byte occupati dalle voci
+    size_t maxMemory; // Limite dei byte occupati dalle voci
+    size_t entries; // Numero di voci
+    size_t hits; // Richieste servite dalla cache
+    size_t misses; // Richieste non presenti nella cache
+    size_t evictions; // Voci eliminate per rispettare il limite di memoria
+    pthread_mutex_t mutex; // Mutex della cache, condivisa dai worker del pool
+} pathCache;
+
+pathCache* pathCacheCreate(size_t);
+bool pathCacheGet(pathCache*, int, int, int*, size_t*);
+void pathCachePut(pathCache*, int, int, const int*, size_t);
+void pathCachePrintStats(pathCache*);
+void pathCacheFree(pathCache*);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef RESPONSES_H
+#define RESPONSES_H
+
+#include "graph.h"
+#include "dataStructures.h"
+#include "bfs.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#define RESPONSE_NO_PATH -1 // Lunghezza di una risposta senza cammino
+#define RESPONSE_INVALID -2 // Lunghezza di una risposta con un codice non valido
+
+typedef enum {
+    RISPOSTE_TSV, // Una linea per risposta: a, b, lunghezza e codice, nome e anno dei nodi del cammino separati da tab
+    RISPOSTE_BINARIO // responseHeader seguito dal testo che avrebbe il file a.b
+} formatoRisposte;
+
+/*
+    Formato binario di una risposta (little endian):
+        responseHeader | dimensione byte di testo, identico al contenuto del file a.b
+*/
+typedef struct {
+    int32_t a; // Codice dell'attore iniziale della richiesta
+    int32_t b; // Codice dell'attore destinazione della richiesta
+    int32_t lunghezza; // Numero di archi del cammino, RESPONSE_NO_PATH o RESPONSE_INVALID
+    uint32_t dimensione; // Byte di testo che seguono l'header
+} responseHeader;
+
+typedef struct {
+    const char* path; // Percorso della named pipe delle risposte
+    formatoRisposte formato; // Formato dei record
+    int fd; // Pipe aperta in scrittura, -1 se nessun lettore è connesso
+    size_t inviate; // Risposte scritte sulla pipe
+    size_t suFile; // Risposte scritte nei file a.b perché nessun lettore era connesso
+    pthread_mutex_t mutex; // Serializza i record dei worker sulla pipe
+} responseChannel;
+
+responseChannel* responseChannelCreate(const char*, formatoRisposte);
+bool responseSendPath(responseChannel*, grafo*, textBuffer*, int32_t, int32_t, const int*, size_t);
+bool responseSendPaths(responseChannel*, grafo*, bfsContext*, pathEnumerator*, int32_t, int32_t, size_t);
+bool responseSendInvalid(responseChannel*, textBuffer*, int32_t, int32_t, int32_t);
+void responseChannelFree(responseChannel*);
+
+#endif
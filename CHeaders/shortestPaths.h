@@ -1,28 +1,91 @@
-#ifndef PATHS_H
-#define PATHS_H
-
-#include "actors.h"
-#include "dataStructures.h"
-
-#include <stdint.h> // Per usare int32_t, probabilmente non necessario ma per sicurezza
-#include <stdbool.h>
-#include <stdio.h>
-
-typedef struct {
-    int32_t a;
-    int32_t b;
-} message;
-
-typedef struct {
-    int32_t a; // Codice dell'attore iniziale
-    int32_t b; // Codice dell'attore destinazione
-    attore** actors; // Array degli attori
-    size_t size; // Size dell'array degli attori
-} pathThreadData;
-
-void pipeReader(size_t, attore**, volatile bool*);
-void createShortestPathThread(int32_t, int32_t, attore**, size_t);
-void* pathThreadBody(void*);
-size_t printShortestPath(attore*, FILE*, int*, attore**, size_t);
-
+#ifndef PATHS_H
+#define PATHS_H
+
+#include "actors.h"
+#include "dataStructures.h"
+#include "graph.h"
+#include "options.h"
+#include "bfs.h"
+#include "threadPool.h"
+#include "pathCache.h"
+#include "responses.h"
+
+#include <stdint.h> // Per usare int32_t, probabilmente non necessario ma per sicurezza
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h> // Per clock_t
+
+#define PIPE_READ_BUFFER 65536 // Byte letti al più da una pipe con una read()
+
+#define MESSAGE_CONSTRAINT INT32_MIN // Valore di a che indica un record di vincolo invece di una richiesta
+
+/*
+    Protocollo delle pipe: ogni record inizia con un intero a 32 bit. Se vale FRAME_MAGIC il record è un frame
+    (frameHeader seguito da lunghezza byte di payload), altrimenti è un messaggio legacy da 8 byte, una richiesta
+    o un record di vincolo. I due formati possono essere mescolati sulla stessa pipe.
+*/
+#define FRAME_MAGIC 0xFF4D4143u // "CAM\xff" in little endian: negativo come int32_t, quindi mai un codice valido
+#define FRAME_VERSION 1 // Versione del protocollo a frame supportata
+#define FRAME_MAX_PAYLOAD 240 // Payload massimo di un frame, i frame più lunghi vengono scartati
+
+typedef enum {
+    OP_CAMMINO = 1, // Cammino minimo tra due attori, payload message
+    OP_CAMMINO_VINCOLATO = 2 // Cammino minimo con vincolo sugli anni di nascita, payload constrainedPayload
+} frameOpcode;
+
+typedef struct {
+    uint32_t magic; // Sempre FRAME_MAGIC
+    uint16_t versione; // Versione del protocollo, FRAME_VERSION
+    uint16_t lunghezza; // Byte di payload che seguono l'header
+    uint32_t idRichiesta; // Identificativo scelto dal client, riportato nei log
+    uint16_t opcode; // Tipo di richiesta, frameOpcode
+    uint16_t riservato; // Sempre 0
+} frameHeader;
+
+typedef struct {
+    int32_t a;
+    int32_t b;
+} message;
+
+typedef struct {
+    int32_t a; // Codice dell'attore iniziale
+    int32_t b; // Codice dell'attore destinazione
+    int16_t annoMin; // Anno di nascita minimo dei nodi intermedi
+    int16_t annoMax; // Anno di nascita massimo dei nodi intermedi
+} constrainedPayload;
+
+/*
+    Record di vincolo legacy, opzionale, della stessa dimensione di una richiesta: limita i nodi intermedi della richiesta
+    legacy successiva sulla stessa pipe agli attori nati tra annoMin e annoMax inclusi.
+*/
+typedef struct {
+    int32_t marcatore; // Sempre MESSAGE_CONSTRAINT
+    int16_t annoMin; // Anno di nascita minimo
+    int16_t annoMax; // Anno di nascita massimo
+} constraintRecord;
+
+_Static_assert(sizeof(constraintRecord) == sizeof(message), "Il record di vincolo deve avere la dimensione di una richiesta");
+_Static_assert(sizeof(frameHeader) == 16, "L'header di un frame occupa 16 byte");
+_Static_assert(sizeof(frameHeader) + FRAME_MAX_PAYLOAD <= PIPE_READ_BUFFER, "Un frame deve entrare in un blocco letto");
+
+typedef struct {
+    int fd; // File descriptor della pipe, non bloccante
+    const char* path; // Percorso della named pipe
+    char resto[sizeof(frameHeader) + FRAME_MAX_PAYLOAD]; // Byte di un record troncato alla fine dell'ultimo blocco letto
+    size_t dimensioneResto; // Numero di byte in resto, sempre minori di un record completo
+    size_t daScartare; // Byte del payload di un frame troppo lungo ancora da scartare
+    bool vincolato; // true se l'ultimo record legacy letto è un vincolo, da applicare alla prossima richiesta legacy
+    yearFilter vincolo; // Vincolo letto, valido solo se vincolato
+} pipeSource;
+
+void pipeReader(threadPool*, const opzioni*, int);
+void formatInvalid(textBuffer*, int32_t);
+void formatNoPath(textBuffer*, int32_t, int32_t);
+void writeInvalidResult(responseChannel*, textBuffer*, int32_t, int32_t, int32_t, clock_t);
+void writePathResult(grafo*, responseChannel*, textBuffer*, int32_t, int32_t, const int*, size_t, clock_t);
+void computeShortestPath(const pathJob*, threadPool*, bfsContext*);
+void formatNode(grafo*, int, textBuffer*);
+size_t formatPath(grafo*, const int*, size_t, textBuffer*);
+size_t formatPaths(grafo*, bfsContext*, pathEnumerator*, size_t, textBuffer*);
+
 #endif
\ No newline at end of file
@@ -1,15 +1,16 @@
-#ifndef SIGNALHANDLER_H
-#define SIGNALHANDLER_H
-
-#include <pthread.h>
-#include <stdbool.h>
-
-typedef struct {
-    volatile bool* finishedGraph;
-    volatile bool* mustShutdown;
-} signalHandlerData;
-
-void signalHandlerThreadInit(volatile bool*, volatile bool*);
-void* signalHandlerBody(void*);
-
+#ifndef SIGNALHANDLER_H
+#define SIGNALHANDLER_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+typedef struct {
+    volatile bool* finishedGraph;
+    volatile bool* mustShutdown;
+    int shutdownFd; // eventfd incrementato insieme a mustShutdown, per svegliare il server delle pipe
+} signalHandlerData;
+
+void signalHandlerThreadInit(volatile bool*, volatile bool*, int);
+void* signalHandlerBody(void*);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "graph.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SNAPSHOT_MAGIC "CAMMINI" // 7 caratteri + '\0' = 8 byte
+#define SNAPSHOT_VERSION 1
+
+/*
+    Formato dello snapshot binario (little endian, tutte le sezioni allineate a 8 byte):
+        header | offsets (uint64[numNodi + 1]) | vicini (int32[numArchi]) | codici (int32[numNodi])
+               | anni (int32[numNodi]) | nomiOffsets (uint64[numNodi + 1]) | nomi (char[dimensioneNomi])
+*/
+typedef struct {
+    char magic[8]; // SNAPSHOT_MAGIC
+    uint32_t versione; // SNAPSHOT_VERSION
+    uint32_t dimensioneHeader; // sizeof(snapshotHeader), per controllo
+    uint64_t numNodi;
+    uint64_t numArchi;
+    uint64_t dimensioneNomi; // Byte del pool dei nomi
+    uint64_t dimensioneFile; // Size totale del file
+    uint64_t sezioneOffsets; // Posizione nel file delle sezioni
+    uint64_t sezioneVicini;
+    uint64_t sezioneCodici;
+    uint64_t sezioneAnni;
+    uint64_t sezioneNomiOffsets;
+    uint64_t sezioneNomi;
+} snapshotHeader;
+
+void saveSnapshot(grafo*, const char*);
+grafo* loadSnapshot(const char*);
+bool snapshotIsUsable(const char*, const char*, const char*);
+
+#endif
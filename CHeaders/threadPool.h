@@ -0,0 +1,51 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include "graph.h"
+#include "bfs.h"
+#include "options.h"
+#include "pathCache.h"
+#include "treeCache.h"
+#include "components.h"
+#include "responses.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+typedef struct {
+    int32_t a; // Codice dell'attore iniziale
+    int32_t b; // Codice dell'attore destinazione
+    uint32_t idRichiesta; // Identificativo del frame della richiesta, 0 per le richieste legacy
+    bool vincolato; // true se i nodi intermedi devono rispettare il vincolo sugli anni di nascita
+    yearFilter vincolo; // Vincolo sugli anni di nascita, valido solo se vincolato
+} pathJob;
+
+typedef struct {
+    pathJob* jobs; // Coda circolare limitata dei lavori in attesa
+    size_t capacity; // Capacità massima della coda dei lavori
+    size_t head; // Indice del primo lavoro in coda
+    size_t count; // Numero di lavori in coda
+    pthread_mutex_t mutex; // Mutex della coda dei lavori
+    pthread_cond_t notEmpty; // Segnalata quando viene aggiunto un lavoro
+    pthread_cond_t notFull; // Segnalata quando viene prelevato un lavoro
+    bool shutdown; // true quando non verranno più aggiunti lavori
+    pthread_t* threads; // Thread worker
+    size_t numThreads; // Numero di thread worker
+    grafo* g; // Grafo degli attori
+    const landmarkIndex* landmarks; // Indice dei landmark (NULL se disabilitato)
+    const componentIndex* componenti; // Componenti connesse del grafo
+    responseChannel* risposte; // Pipe delle risposte (NULL se le risposte vanno nei file a.b)
+    pathCache* cache; // Cache dei cammini condivisa dai worker (NULL se disabilitata)
+    treeCache* alberi; // Cache degli alberi BFS delle sorgenti più richieste (NULL se disabilitata)
+    const opzioni* opts; // Opzioni passate da linea di comando
+} threadPool;
+
+threadPool* poolCreate(grafo*, const landmarkIndex*, const componentIndex*, responseChannel*, const opzioni*);
+void poolSubmit(threadPool*, const pathJob*);
+void poolSubmitBatch(threadPool*, const pathJob*, size_t);
+void poolDestroy(threadPool*);
+void* poolWorkerBody(void*);
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+    Tokenizer per i file nomi.txt e grafo.txt, lavora su buffer non terminati da '\0' (file mappati in memoria)
+    e non legge mai oltre la fine passata. Le funzioni chiamate per ogni token sono definite static inline
+    nell'header, così vengono espanse nei cicli di parsing dei due loader.
+*/
+
+const char* findByte(const char*, const char*, char);
+size_t countByte(const char*, const char*, char);
+void splitBlocks(const char*, size_t, size_t, const char**);
+
+/**
+ * @brief Restituisce la lunghezza della sequenza di cifre decimali che inizia in p.
+ * @details Con SSE2 confronta 16 byte alla volta, altrimenti scorre byte per byte.
+ * @param p Inizio della sequenza.
+ * @param end Fine (esclusa) del buffer.
+ * @return Numero di cifre consecutive.
+ */
+static inline size_t digitRunLength(const char* p, const char* end) {
+    const char* c = p;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+
+    while (end - c >= 16) {
+        // Un byte è una cifra se (byte - '0') come unsigned è <= 9
+        __m128i v = _mm_sub_epi8(_mm_loadu_si128((const __m128i*) c), zero);
+        __m128i isDigit = _mm_cmpeq_epi8(_mm_max_epu8(v, nine), nine);
+        unsigned mask = ~(unsigned) _mm_movemask_epi8(isDigit) & 0xFFFF;
+
+        if (mask != 0) return (c - p) + __builtin_ctz(mask);
+        c += 16;
+    }
+#endif
+
+    while (c < end && (unsigned char) (*c - '0') <= 9) c++;
+    return c - p;
+}
+
+/**
+ * @brief Converte esattamente len cifre (1 <= len <= 8) con operazioni SWAR su una parola a 64 bit.
+ * @details Richiede che gli 8 byte a partire da p siano leggibili.
+ * @param p Inizio delle cifre.
+ * @param len Numero di cifre.
+ * @return Valore delle cifre.
+ */
+static inline uint32_t parseEightDigits(const char* p, size_t len) {
+    uint64_t val;
+    memcpy(&val, p, sizeof(val));
+
+    // Allinea le cifre alla parte alta della parola e riempie la parte bassa con '0'
+    unsigned shift = (unsigned) (8 - len) * 8;
+    if (shift > 0) val = (val << shift) | (0x3030303030303030ULL >> (64 - shift));
+
+    val -= 0x3030303030303030ULL;
+    val = (val * 10) + (val >> 8);
+    val = (((val & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)))
+        + (((val >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+
+    return (uint32_t) val;
+}
+
+/**
+ * @brief Legge il prossimo intero decimale, con un '-' iniziale opzionale, saltando i separatori ('\t', ' ', '\r') che lo precedono.
+ * @param p Puntatore alla posizione corrente, viene spostato dopo l'intero letto.
+ * @param end Fine (esclusa) del buffer, di solito la fine della linea.
+ * @param result Puntatore al risultato.
+ * @return true se è stato letto un intero, false se non ci sono altri interi prima di end o se il valore non sta in un int.
+ */
+static inline bool nextInt(const char** p, const char* end, int* result) {
+    const char* c = *p;
+
+    while (c < end && (*c == '\t' || *c == ' ' || *c == '\r')) c++;
+
+    bool negative = c < end && *c == '-';
+    if (negative) c++;
+
+    size_t len = digitRunLength(c, end);
+    if (len == 0) return false; // Anche un '-' isolato non è un intero
+
+    int64_t value;
+    if (len <= 8 && end - c >= 8) {
+        value = parseEightDigits(c, len);
+    } else {
+        // Accumula a 64 bit e si ferma appena il valore supera il modulo di INT_MIN, così non trabocca mai
+        value = 0;
+        for (size_t i = 0; i < len; i++) {
+            value = value * 10 + (c[i] - '0');
+            if (value > (int64_t) INT_MAX + 1) return false;
+        }
+    }
+
+    if (!negative && value > INT_MAX) return false;
+
+    *result = (int) (negative ? -value : value);
+    *p = c + len;
+    return true;
+}
+
+/**
+ * @brief Legge il prossimo campo delimitato da '\t' (o dalla fine della linea).
+ * @param p Puntatore alla posizione corrente, viene spostato dopo il delimitatore.
+ * @param end Fine (esclusa) della linea.
+ * @param length Impostato alla lunghezza del campo.
+ * @return Inizio del campo, NULL se la linea è finita.
+ */
+static inline const char* nextField(const char** p, const char* end, size_t* length) {
+    const char* start = *p;
+    if (start >= end) return NULL;
+
+    const char* tab = findByte(start, end, '\t');
+    *length = tab - start;
+    *p = (tab < end) ? tab + 1 : end;
+
+    return start;
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef TREECACHE_H
+#define TREECACHE_H
+
+#include "graph.h"
+#include "bfs.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#define TREE_CACHE_THRESHOLD 3 // Richieste con la stessa sorgente dopo cui viene memorizzato il suo albero BFS
+#define TREE_CACHE_AGING_PERIOD 1024 // Richieste dopo cui i contatori di tutte le sorgenti vengono dimezzati
+#define TREE_NOT_REACHED -2 // Genitore dei nodi non raggiungibili dalla sorgente
+
+typedef struct {
+    int source; // Id denso della sorgente dell'albero
+    int* parents; // Array dei genitori della BFS completa da source, -1 per source e TREE_NOT_REACHED per i non raggiungibili
+} treeSlot;
+
+typedef struct {
+    treeSlot* slots; // Alberi memorizzati
+    size_t capacity; // Numero massimo di alberi
+    size_t used; // Numero di alberi memorizzati
+    uint32_t* richieste; // Numero di richieste per sorgente, indicizzato per id denso, dimezzato ad ogni era trascorsa
+    uint32_t* ere; // Era dell'ultimo aggiornamento di richieste, per l'invecchiamento pigro dei contatori
+    uint32_t era; // Era corrente, incrementata ogni TREE_CACHE_AGING_PERIOD richieste
+    uint64_t registrate; // Richieste registrate in totale
+    size_t numNodi; // Numero di nodi del grafo
+    size_t hits; // Richieste servite da un albero
+    size_t misses; // Richieste senza un albero per nessuno dei due estremi
+    size_t built; // Alberi calcolati
+    pthread_mutex_t mutex; // Mutex della cache, condivisa dai worker del pool
+} treeCache;
+
+treeCache* treeCacheCreate(size_t, size_t);
+bool treeCacheGet(treeCache*, int, int, int*, size_t*);
+bool treeCacheShouldBuild(treeCache*, int);
+void treeCachePut(treeCache*, int, bfsContext*);
+void treeCachePrintStats(treeCache*);
+void treeCacheFree(treeCache*);
+
+#endif
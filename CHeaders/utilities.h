@@ -1,11 +1,16 @@
-#ifndef UTILITIES_H
-#define UTILITIES_H
-
-#include <stdbool.h>
-#include <stdio.h>
-
-void errorAndExit(const char*, ...);
-void handleWithFileError(char*, FILE*);
-bool validateArguments(int, char**);
-
+#ifndef UTILITIES_H
+#define UTILITIES_H
+
+#include "options.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+
+void errorAndExit(const char*, ...);
+void handleWithFileError(char*, FILE*);
+bool validateArguments(int, char**, opzioni*);
+char* mapFile(const char*, size_t*);
+void unmapFile(char*, size_t);
+char* readFile(const char*, size_t*);
+
 #endif
\ No newline at end of file
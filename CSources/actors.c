@@ -1,170 +1,162 @@
-#define _GNU_SOURCE
-
-#include "../CHeaders/actors.h"
-#include "../CHeaders/xerrori.h"
-#include "../CHeaders/utilities.h"
-
-#include <stdlib.h>
-#include <string.h>
-
-#define INITIAL_ACTORS_CAPACITY 383965
-
-/**
- * @brief Dealloca la memoria dell'array degli attori.
- * @param arr Puntatore all'array.
- * @param size Lunghezza dell'array.
- */
-void freeAttori(attore** arr, size_t size) {
-    for (size_t i = 0; i < size; i++) {
-        if (!arr[i]) continue;
-
-        if (arr[i] -> nome) free(arr[i] -> nome);
-        
-        if (arr[i] -> cop) free(arr[i] -> cop);
-
-        free(arr[i]);
-    }
-
-    free(arr);
-}
-
-/**
- * @brief Crea l'array dei nodi attore leggendo il file nomi.txt
- * @param filePath Percorso del file nomi.txt
- * @param arrSize Puntatore alla variabile contenente la size dell'array, che viene aggiornato.
- * @return Array degli attori.
- */
-attore** createActors(char* filePath, size_t* arrSize) {
-    FILE* file = xfopen(filePath, "r", LINEFILE);
-
-    // Inizializza array dei nodi attore
-    size_t size = INITIAL_ACTORS_CAPACITY;
-    attore** attori = malloc(size * sizeof(attore*));
-    if (attori == NULL) handleWithFileError("Allocazione dell'array degli attori fallita", file);
-
-    char* line = NULL; // Buffer per la linea
-    size_t len = 0; // Dimensione iniziale del buffer
-    ssize_t read; // Numero di caratteri letti (-1 per fine del file o errore)
-    size_t counter = 0; // Counter per l'array
-
-    // Ciclo di lettura dal file nomi.txt
-    while ((read = getline(&line, &len, file)) != -1) {
-        if (read <= 1 || line[0] == '\n') continue; // Salta ultima linea o linee vuote
-        
-        // Resize dell'array degli attori
-        if (counter >= size) {
-            size *= 1.5;
-
-            attore** tempAttori = realloc(attori, size * sizeof(attore*));
-            if (tempAttori == NULL) {
-                freeAttori(attori, size / 1.5);
-                free(line);
-                handleWithFileError("Riallocazione dell'array degli attori fallita", file);
-            }
-
-            attori = tempAttori;
-        }
-
-        // Creazione nodo attuale
-        attore* current = malloc(sizeof(attore));
-        if (current == NULL) {
-            freeAttori(attori, size);
-            free(line);
-            handleWithFileError("Allocazione di un nodo attore fallita", file);
-        }
-
-        // Parsing della linea attuale
-        char* token = strtok(line, "\t");
-        if (token == NULL) {
-            freeAttori(attori, size);
-            free(current);
-            free(line);
-            handleWithFileError("Linea del file nomi.txt mal formattata", file);
-        }
-        current -> codice = atoi(token);
-
-        token = strtok(NULL, "\t");
-        if (token == NULL) {
-            freeAttori(attori, size);
-            free(current);
-            free(line);
-            handleWithFileError("Linea del file nomi.txt mal formattata", file);
-        }
-        current -> nome = strdup(token);
-        if (current -> nome == NULL) {
-            freeAttori(attori, size);
-            free(current);
-            free(line);
-            handleWithFileError("strdup fallita durante la creazione di un nodo attore", file);
-        }
-
-        token = strtok(NULL, "\t");
-        if (token == NULL) {
-            freeAttori(attori, size);
-            free(current -> nome);
-            free(current);
-            free(line);
-            handleWithFileError("Linea del file nomi.txt mal formattata", file);
-        }
-        current -> anno = atoi(token);
-
-        // Aggiunta del nodo attuale all'array
-        attori[counter++] = current;
-    }
-
-    // Check se c'è stato un errore durante la lettura dal file
-    if (ferror(file)) {
-        perror("Errore: Lettura dal file nomi.txt fallita");
-        freeAttori(attori, size);
-        free(line);
-        fclose(file);
-        exit(2);
-    }
-
-    free(line);
-
-    // Resize dell'array degli attori (non necessario dato che dovrebbero essere precisi, ma non si sa mai)
-    if (counter < INITIAL_ACTORS_CAPACITY) {
-        size = counter;
-
-        attore** tempAttori = realloc(attori, size * sizeof(attore*));
-        if (tempAttori == NULL) {
-            freeAttori(attori, size);
-            handleWithFileError("Riallocazione dell'array degli attori fallita", file);
-        }
-
-        attori = tempAttori;
-    }
-
-    fclose(file);
-    *arrSize = size;
-    return attori;
-}
-
-/**
- * @brief Compara due attori per codice.
- * @param key Nodo da cercare.
- * @param element Nodo con cui si sta confrontando.
- * @return Intero rappresentante il risultato della comparazione (< 0 -> oggetto cercato <, 0 -> oggetto cercato uguale, > 0 -> oggetto cercato maggiore)
- */
-int  compareAttore(const void* key, const void* element) {
-    int codice = *(const int*) key;
-    const attore* a = *(const attore* const*) element;
-    return codice - (a -> codice);
-}
-
-/**
- * @brief Restituisce le informazioni dell'attore formattate: codice\tnome\tannoDiNascita
- * @param a Attore da calcolare.
- * @return Stringa formattata allocata dinamicamente.
- */
-char* actorToString(attore* a) {
-    if (!a) xtermina(LINEFILE, "actorToString() chiamata su attore invalido");
-    if (!a -> nome) xtermina(LINEFILE, "actorToString() chiamata su attore con nome invalido");
-
-    char string[100]; // Abbastanza per evitare overflow
-    
-    sprintf(string, "%d\t%s\t%d\t", a -> codice, a -> nome, a -> anno);
-
-    return strdup(string);
-}
\ No newline at end of file
+#define _GNU_SOURCE
+
+#include "../CHeaders/actors.h"
+#include "../CHeaders/xerrori.h"
+#include "../CHeaders/utilities.h"
+
+#include "../CHeaders/tokenizer.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/**
+ * @brief Esegue il parsing di una linea di nomi.txt in formato codice\tnome\tanno
+ * @param p Inizio della linea.
+ * @param lineEnd Fine (esclusa) della linea.
+ * @param current Attore da riempire, tranne il campo nome.
+ * @param nameLength Impostato alla lunghezza del nome.
+ * @return Inizio del nome all'interno della linea.
+ */
+static const char* parseActorLine(const char* p, const char* lineEnd, attore* current, size_t* nameLength) {
+    if (!nextInt(&p, lineEnd, &current -> codice) || p == lineEnd || *p != '\t') xtermina(LINEFILE, "Linea del file nomi.txt mal formattata");
+    p++;
+
+    const char* name = nextField(&p, lineEnd, nameLength);
+    if (name == NULL || name + *nameLength == lineEnd) xtermina(LINEFILE, "Linea del file nomi.txt mal formattata");
+
+    // Un anno non numerico vale 0, come con atoi()
+    if (!nextInt(&p, lineEnd, &current -> anno)) current -> anno = 0;
+
+    current -> numcop = 0; // Per gli attori senza linea in grafo.txt
+    current -> cop = NULL;
+
+    return name;
+}
+
+/**
+ * @brief Controlla se una linea è vuota.
+ * @param p Inizio della linea.
+ * @param lineEnd Fine (esclusa) della linea.
+ * @return true se la linea è vuota, false altrimenti.
+ */
+static bool isEmptyLine(const char* p, const char* lineEnd) {
+    return p == lineEnd || (lineEnd - p == 1 && *p == '\r');
+}
+
+/**
+ * @brief Funzione eseguita dai thread lettori di nomi.txt, esegue il parsing di un blocco di linee.
+ * @details Gli attori vengono scritti nella porzione dell'array contiguo riservata al blocco e i nomi
+ *          nella porzione del pool dei nomi che corrisponde ai byte del blocco, che è sempre sufficiente.
+ * @param arg Struct actorsWorkerData del blocco.
+ */
+void* actorsWorkerBody(void* arg) {
+    actorsWorkerData* data = (actorsWorkerData*) arg;
+
+    const char* line = data -> start;
+    char* nomi = data -> nomi;
+    size_t count = 0;
+
+    while (line < data -> end) {
+        const char* lineEnd = findByte(line, data -> end, '\n');
+        const char* p = line;
+        line = lineEnd + 1;
+
+        if (isEmptyLine(p, lineEnd)) continue;
+
+        attore* current = &(data -> attori)[count++];
+
+        size_t nameLength = 0;
+        const char* name = parseActorLine(p, lineEnd, current, &nameLength);
+
+        memcpy(nomi, name, nameLength);
+        nomi[nameLength] = '\0';
+        current -> nome = nomi;
+        nomi += nameLength + 1;
+    }
+
+    data -> count = count;
+    data -> nomiUsati = nomi - data -> nomi;
+
+    pthread_exit(NULL);
+}
+
+/**
+ * @brief Legge nomi.txt con n thread, scrivendo gli attori in un unico array contiguo e i nomi in un unico pool.
+ * @details Il file viene mappato in memoria e diviso in blocchi allineati alle linee. Ad ogni blocco vengono riservati
+ *          tanti attori quante sono le sue linee e tanti byte del pool quanti sono i suoi byte, così i thread scrivono
+ *          senza sincronizzazione; alla fine le porzioni vengono compattate. Attori, nomi e array dei puntatori
+ *          vengono assegnati dall'arena, che viene usata solo da questo thread fino al termine della funzione.
+ * @param filePath Percorso del file nomi.txt
+ * @param n Numero di thread lettori.
+ * @param memoria Arena da cui allocare i dati degli attori.
+ * @param tabella Struttura da riempire con gli attori letti.
+ */
+void loadActors(char* filePath, size_t n, arena* memoria, tabellaAttori* tabella) {
+    if (n == 0) n = 1;
+
+    size_t fileSize;
+    char* text = mapFile(filePath, &fileSize);
+
+    const char** starts = malloc((n + 1) * sizeof(char*));
+    size_t* slots = malloc((n + 1) * sizeof(size_t));
+    pthread_t* threads = malloc(n * sizeof(pthread_t));
+    actorsWorkerData* threadData = malloc(n * sizeof(actorsWorkerData));
+    if (starts == NULL || slots == NULL || threads == NULL || threadData == NULL) xtermina(LINEFILE, "Allocazione degli array dei thread lettori di nomi.txt fallita");
+
+    splitBlocks(text, fileSize, n, starts);
+
+    // Riserva ad ogni blocco un attore per linea
+    slots[0] = 0;
+    for (size_t i = 0; i < n; i++) slots[i + 1] = slots[i] + countByte(starts[i], starts[i + 1], '\n') + 1;
+
+    attore* blocco = arenaAlloc(memoria, slots[n] * sizeof(attore));
+    char* nomi = arenaAlloc(memoria, fileSize + 1);
+
+    for (size_t i = 0; i < n; i++) {
+        threadData[i].start = starts[i];
+        threadData[i].end = starts[i + 1];
+        threadData[i].attori = blocco + slots[i];
+        threadData[i].nomi = nomi + (starts[i] - text);
+
+        xpthread_create(&threads[i], NULL, &actorsWorkerBody, &threadData[i], LINEFILE);
+    }
+
+    for (size_t i = 0; i < n; i++) xpthread_join(threads[i], NULL, LINEFILE);
+
+    // Compatta attori e nomi dei blocchi, spostandoli solo verso sinistra
+    size_t size = 0, dimensioneNomi = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        attore* source = threadData[i].attori;
+        char* sourceNomi = threadData[i].nomi;
+
+        memmove(blocco + size, source, threadData[i].count * sizeof(attore));
+        memmove(nomi + dimensioneNomi, sourceNomi, threadData[i].nomiUsati);
+
+        for (size_t j = 0; j < threadData[i].count; j++) {
+            blocco[size + j].nome = nomi + dimensioneNomi + (blocco[size + j].nome - sourceNomi);
+        }
+
+        size += threadData[i].count;
+        dimensioneNomi += threadData[i].nomiUsati;
+    }
+
+    // Restituisce all'arena la parte del pool non usata dai nomi
+    arenaTrim(memoria, nomi, dimensioneNomi);
+
+    attore** attori = arenaAlloc(memoria, size * sizeof(attore*));
+
+    for (size_t i = 0; i < size; i++) attori[i] = &blocco[i];
+
+    unmapFile(text, fileSize);
+    free(starts);
+    free(slots);
+    free(threads);
+    free(threadData);
+
+    tabella -> attori = attori;
+    tabella -> size = size;
+    tabella -> nomi = nomi;
+    tabella -> dimensioneNomi = dimensioneNomi;
+}
@@ -0,0 +1,367 @@
+#define _GNU_SOURCE
+
+#include "../CHeaders/analysis.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h> // Per PRIu64
+#include <sys/times.h>
+
+/**
+ * @brief Aggiorna un valore condiviso con il massimo tra il valore attuale e uno nuovo, senza lock.
+ * @param target Valore condiviso.
+ * @param value Nuovo valore.
+ */
+static void atomicMax(uint32_t* target, uint32_t value) {
+    uint32_t current = __atomic_load_n(target, __ATOMIC_RELAXED);
+
+    while (current < value && !__atomic_compare_exchange_n(target, &current, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+/**
+ * @brief Secondi trascorsi da un istante ottenuto con times().
+ * @param start Istante di partenza.
+ * @return Secondi trascorsi.
+ */
+static double secondsSince(clock_t start) {
+    return (double)(times(NULL) - start) / sysconf(_SC_CLK_TCK);
+}
+
+/**
+ * @brief Visita completa bit-parallela da fino a ANALYSIS_WIDTH sorgenti, senza memorizzare le distanze.
+ * @details Come msbfsRun() ogni arco viene esaminato una sola volta per livello per tutte le sorgenti, ma invece
+ *          delle distanze per sorgente (64 byte per nodo) accumula solo quello che serve all'analisi: a ogni livello
+ *          il numero di coppie (sorgente, nodo) raggiunte, il massimo livello a cui ogni nodo viene raggiunto e,
+ *          per ogni sorgente, l'ultimo livello in cui raggiunge nuovi nodi, cioè la sua eccentricità.
+ * @param state Stato condiviso dell'analisi.
+ * @param w Buffer del worker chiamante.
+ * @param sources Id densi delle sorgenti, distinti.
+ * @param numSources Numero di sorgenti.
+ */
+static void sweep(analysisState* state, analysisWorker* w, const int* sources, size_t numSources) {
+    grafo* g = state -> g;
+    size_t n = g -> numNodi;
+    uint64_t* seen = w -> seen;
+    uint64_t* visit = w -> visit;
+    uint64_t* visitNext = w -> visitNext;
+
+    memset(seen, 0, n * sizeof(uint64_t));
+    memset(visit, 0, n * sizeof(uint64_t));
+    memset(visitNext, 0, n * sizeof(uint64_t));
+
+    uint32_t sourceEccentricity[ANALYSIS_WIDTH] = {0};
+
+    for (size_t s = 0; s < numSources; s++) {
+        seen[sources[s]] |= 1ULL << s;
+        visit[sources[s]] |= 1ULL << s;
+    }
+
+    uint32_t level = 0;
+    bool active = numSources > 0;
+
+    while (active) {
+        level++;
+        active = false;
+
+        uint64_t reached = 0; // Coppie raggiunte a questo livello
+        uint64_t growing = 0; // Sorgenti che raggiungono nuovi nodi a questo livello
+
+        for (size_t v = 0; v < n; v++) {
+            uint64_t frontier = visit[v];
+            if (frontier == 0) continue;
+
+            w -> archiEsaminati += g -> offsets[v + 1] - g -> offsets[v];
+
+            for (size_t i = g -> offsets[v]; i < g -> offsets[v + 1]; i++) {
+                int u = g -> vicini[i];
+
+                uint64_t newBits = frontier & ~seen[u];
+                if (newBits == 0) continue;
+
+                visitNext[u] |= newBits;
+                seen[u] |= newBits;
+                active = true;
+
+                reached += __builtin_popcountll(newBits);
+                growing |= newBits;
+
+                // I livelli crescono, quindi l'ultimo livello a cui u viene raggiunto è la sua distanza massima dal lotto
+                atomicMax(&state -> eccentricita[u], level);
+            }
+        }
+
+        if (!active) break;
+
+        if (level >= w -> dimensioneIstogramma) {
+            size_t newSize = w -> dimensioneIstogramma * 2;
+            while (newSize <= level) newSize *= 2;
+
+            uint64_t* newHistogram = realloc(w -> istogramma, newSize * sizeof(uint64_t));
+            if (newHistogram == NULL) xtermina(LINEFILE, "Riallocazione dell'istogramma dell'analisi fallita");
+
+            memset(newHistogram + w -> dimensioneIstogramma, 0, (newSize - w -> dimensioneIstogramma) * sizeof(uint64_t));
+            w -> istogramma = newHistogram;
+            w -> dimensioneIstogramma = newSize;
+        }
+
+        w -> istogramma[level] += reached;
+
+        while (growing) {
+            sourceEccentricity[__builtin_ctzll(growing)] = level;
+            growing &= growing - 1;
+        }
+
+        // La frontiera successiva diventa quella corrente, la vecchia viene azzerata per il prossimo livello
+        uint64_t* temp = visit;
+        visit = visitNext;
+        visitNext = temp;
+        memset(visitNext, 0, n * sizeof(uint64_t));
+    }
+
+    w -> visit = visit;
+    w -> visitNext = visitNext;
+
+    // L'eccentricità di una sorgente è esatta: la sua visita ha raggiunto l'intera componente
+    for (size_t s = 0; s < numSources; s++) {
+        atomicMax(&state -> eccentricita[sources[s]], sourceEccentricity[s]);
+        state -> esatta[sources[s]] = true;
+    }
+}
+
+/**
+ * @brief Funzione eseguita dai worker dell'analisi: prelevano un lotto di sorgenti alla volta finché non sono finiti.
+ * @param arg Puntatore allo stato condiviso dell'analisi.
+ */
+void* analysisWorkerBody(void* arg) {
+    analysisState* state = (analysisState*) arg;
+    size_t n = state -> g -> numNodi;
+
+    // Buffer del worker, allocati una sola volta per tutti i lotti
+    analysisWorker w;
+    w.seen = malloc((n > 0 ? n : 1) * sizeof(uint64_t));
+    w.visit = malloc((n > 0 ? n : 1) * sizeof(uint64_t));
+    w.visitNext = malloc((n > 0 ? n : 1) * sizeof(uint64_t));
+    w.dimensioneIstogramma = 64;
+    w.istogramma = calloc(w.dimensioneIstogramma, sizeof(uint64_t));
+    w.archiEsaminati = 0;
+    if (w.seen == NULL || w.visit == NULL || w.visitNext == NULL || w.istogramma == NULL) xtermina(LINEFILE, "Allocazione dei buffer del worker dell'analisi fallita");
+
+    size_t numLots = (state -> numSorgenti + ANALYSIS_WIDTH - 1) / ANALYSIS_WIDTH;
+
+    while (true) {
+        // Zona critica
+        xpthread_mutex_lock(&state -> mutex, LINEFILE);
+
+        size_t index = state -> prossimoLotto;
+        if (index < numLots && !(*(state -> mustShutdown))) state -> prossimoLotto++;
+        else index = numLots;
+
+        xpthread_mutex_unlock(&state -> mutex, LINEFILE);
+        // Fine zona critica
+
+        if (index == numLots) break;
+
+        size_t first = index * ANALYSIS_WIDTH;
+        size_t count = state -> numSorgenti - first < ANALYSIS_WIDTH ? state -> numSorgenti - first : ANALYSIS_WIDTH;
+
+        uint64_t edgesBefore = w.archiEsaminati;
+        sweep(state, &w, state -> sorgenti + first, count);
+
+        // Zona critica
+        xpthread_mutex_lock(&state -> mutex, LINEFILE);
+
+        state -> sorgentiCompletate += count;
+        state -> archiEsaminati += w.archiEsaminati - edgesBefore;
+
+        if (secondsSince(state -> ultimaStampa) >= ANALYSIS_PROGRESS_SECONDS) {
+            double elapsed = secondsSince(state -> inizio);
+            double rate = elapsed > 0 ? state -> sorgentiCompletate / elapsed : 0;
+
+            fprintf(stderr, "Analisi: %zu/%zu sorgenti (%.1f%%), %.0f sorgenti/s, %.1f milioni di archi/s, fine stimata tra %.0f secondi.\n",
+                    state -> sorgentiCompletate, state -> numSorgenti, 100.0 * state -> sorgentiCompletate / state -> numSorgenti, rate,
+                    elapsed > 0 ? state -> archiEsaminati / elapsed / 1e6 : 0.0, rate > 0 ? (state -> numSorgenti - state -> sorgentiCompletate) / rate : 0.0);
+
+            state -> ultimaStampa = times(NULL);
+        }
+
+        xpthread_mutex_unlock(&state -> mutex, LINEFILE);
+        // Fine zona critica
+    }
+
+    // Unisce l'istogramma locale a quello condiviso
+    xpthread_mutex_lock(&state -> mutex, LINEFILE);
+
+    if (w.dimensioneIstogramma > state -> dimensioneIstogramma) {
+        uint64_t* newHistogram = realloc(state -> istogramma, w.dimensioneIstogramma * sizeof(uint64_t));
+        if (newHistogram == NULL) xtermina(LINEFILE, "Riallocazione dell'istogramma dell'analisi fallita");
+
+        memset(newHistogram + state -> dimensioneIstogramma, 0, (w.dimensioneIstogramma - state -> dimensioneIstogramma) * sizeof(uint64_t));
+        state -> istogramma = newHistogram;
+        state -> dimensioneIstogramma = w.dimensioneIstogramma;
+    }
+
+    for (size_t d = 0; d < w.dimensioneIstogramma; d++) state -> istogramma[d] += w.istogramma[d];
+
+    xpthread_mutex_unlock(&state -> mutex, LINEFILE);
+
+    free(w.seen);
+    free(w.visit);
+    free(w.visitNext);
+    free(w.istogramma);
+
+    pthread_exit(NULL);
+}
+
+/**
+ * @brief Sceglie le sorgenti di un'analisi: tutti i nodi, oppure un campione casuale senza ripetizioni.
+ * @details Il seme è fisso, quindi lo stesso numero di campioni dà sempre le stesse sorgenti.
+ * @param n Numero di nodi del grafo.
+ * @param numCampioni Numero di sorgenti da campionare, 0 (o almeno n) per l'analisi esatta.
+ * @param numSorgenti Impostato al numero di sorgenti scelte.
+ * @return Array degli id densi delle sorgenti.
+ */
+int* chooseSources(size_t n, size_t numCampioni, size_t* numSorgenti) {
+    int* sources = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (sources == NULL) xtermina(LINEFILE, "Allocazione delle sorgenti dell'analisi fallita");
+
+    for (size_t v = 0; v < n; v++) sources[v] = v;
+
+    if (numCampioni == 0 || numCampioni >= n) {
+        *numSorgenti = n;
+        return sources;
+    }
+
+    // Fisher-Yates parziale: le prime numCampioni posizioni sono un campione uniforme
+    unsigned int seed = 42;
+
+    for (size_t i = 0; i < numCampioni; i++) {
+        size_t j = i + ((size_t) rand_r(&seed) * (RAND_MAX + 1ULL) + rand_r(&seed)) % (n - i);
+        int tmp = sources[i];
+        sources[i] = sources[j];
+        sources[j] = tmp;
+    }
+
+    *numSorgenti = numCampioni;
+    return sources;
+}
+
+/**
+ * @brief Scrive l'istogramma dei gradi di separazione e stampa su stderr le statistiche riassuntive.
+ * @param state Stato dell'analisi terminata.
+ * @param numSorgenti Sorgenti effettivamente visitate.
+ */
+static void writeHistogram(analysisState* state, size_t numSorgenti) {
+    size_t n = state -> g -> numNodi;
+
+    uint64_t connected = 0, weighted = 0;
+    size_t diameter = 0;
+
+    for (size_t d = 1; d < state -> dimensioneIstogramma; d++) {
+        connected += state -> istogramma[d];
+        weighted += state -> istogramma[d] * d;
+        if (state -> istogramma[d] > 0) diameter = d;
+    }
+
+    uint64_t unreachable = (uint64_t) numSorgenti * (n > 0 ? n - 1 : 0) - connected;
+
+    FILE* file = xfopen(ANALYSIS_HISTOGRAM_FILE, "w", LINEFILE);
+    fprintf(file, "distanza\tcoppie\tfrazione\tcumulata\n");
+
+    uint64_t cumulative = 0;
+    size_t effective = 0;
+
+    for (size_t d = 1; d <= diameter; d++) {
+        cumulative += state -> istogramma[d];
+        if (effective == 0 && cumulative >= ANALYSIS_EFFECTIVE_PERCENTILE * connected) effective = d;
+
+        fprintf(file, "%zu\t%" PRIu64 "\t%.6f\t%.6f\n", d, state -> istogramma[d], (double) state -> istogramma[d] / connected, (double) cumulative / connected);
+    }
+
+    fprintf(file, "irraggiungibili\t%" PRIu64 "\t\t\n", unreachable);
+    fclose(file);
+
+    fprintf(stderr, "Coppie connesse %" PRIu64 ", non connesse %" PRIu64 ": separazione media %.3f, diametro %zu, diametro efficace (%.0f%%) %zu. Istogramma scritto in %s.\n",
+            connected, unreachable, connected > 0 ? (double) weighted / connected : 0.0, diameter, 100 * ANALYSIS_EFFECTIVE_PERCENTILE, effective, ANALYSIS_HISTOGRAM_FILE);
+}
+
+/**
+ * @brief Scrive l'eccentricità di ogni nodo, con un flag che indica se è esatta o un limite inferiore.
+ * @param state Stato dell'analisi terminata.
+ */
+static void writeEccentricity(analysisState* state) {
+    grafo* g = state -> g;
+
+    FILE* file = xfopen(ANALYSIS_ECCENTRICITY_FILE, "w", LINEFILE);
+    fprintf(file, "codice\tnome\teccentricita\tesatta\n");
+
+    for (size_t v = 0; v < g -> numNodi; v++) {
+        fprintf(file, "%d\t%s\t%u\t%d\n", g -> codici[v], nodeName(g, v), state -> eccentricita[v], state -> esatta[v]);
+    }
+
+    fclose(file);
+
+    fprintf(stderr, "Eccentricità dei nodi scritte in %s.\n", ANALYSIS_ECCENTRICITY_FILE);
+}
+
+/**
+ * @brief Modalità analisi: distribuzione dei gradi di separazione ed eccentricità di ogni nodo.
+ * @details Le sorgenti (tutti i nodi, o un campione di opts -> numCampioni nodi) vengono divise in lotti di ANALYSIS_WIDTH
+ *          visitati con un'unica visita bit-parallela, distribuiti tra opts -> numThread worker. Nell'analisi esatta
+ *          l'eccentricità di ogni nodo è esatta, in quella campionata lo è solo per le sorgenti e per gli altri nodi
+ *          è un limite inferiore. All'arrivo di SIGINT i lotti non iniziati vengono saltati e i risultati scritti
+ *          su quelli completati.
+ * @param g Grafo degli attori.
+ * @param opts Opzioni passate da linea di comando.
+ * @param mustShutdown Booleano per gestire l'arrivo di SIGINT.
+ */
+void runAnalysis(grafo* g, const opzioni* opts, volatile bool* mustShutdown) {
+    size_t n = g -> numNodi;
+
+    analysisState state;
+    state.g = g;
+    state.sorgenti = chooseSources(n, opts -> numCampioni, &state.numSorgenti);
+    state.prossimoLotto = 0;
+    state.sorgentiCompletate = 0;
+    state.eccentricita = calloc(n > 0 ? n : 1, sizeof(uint32_t));
+    state.esatta = calloc(n > 0 ? n : 1, sizeof(bool));
+    state.dimensioneIstogramma = 64;
+    state.istogramma = calloc(state.dimensioneIstogramma, sizeof(uint64_t));
+    state.archiEsaminati = 0;
+    state.inizio = times(NULL);
+    state.ultimaStampa = state.inizio;
+    state.mustShutdown = mustShutdown;
+    if (state.eccentricita == NULL || state.esatta == NULL || state.istogramma == NULL) xtermina(LINEFILE, "Allocazione dei risultati dell'analisi fallita");
+    xpthread_mutex_init(&state.mutex, NULL, LINEFILE);
+
+    size_t numLots = (state.numSorgenti + ANALYSIS_WIDTH - 1) / ANALYSIS_WIDTH;
+    size_t numWorkers = opts -> numThread < numLots ? opts -> numThread : numLots;
+
+    fprintf(stderr, "Inizio analisi %s: %zu sorgenti in %zu lotti con %zu worker.\n",
+            state.numSorgenti == n ? "esatta" : "campionata", state.numSorgenti, numLots, numWorkers);
+
+    pthread_t* workers = malloc((numWorkers > 0 ? numWorkers : 1) * sizeof(pthread_t));
+    if (workers == NULL) xtermina(LINEFILE, "Allocazione dei worker dell'analisi fallita");
+
+    for (size_t i = 0; i < numWorkers; i++) xpthread_create(&workers[i], NULL, &analysisWorkerBody, &state, LINEFILE);
+    for (size_t i = 0; i < numWorkers; i++) xpthread_join(workers[i], NULL, LINEFILE);
+
+    double elapsed = secondsSince(state.inizio);
+
+    if (state.sorgentiCompletate < state.numSorgenti) fprintf(stderr, "Analisi interrotta: risultati su %zu sorgenti su %zu.\n", state.sorgentiCompletate, state.numSorgenti);
+
+    fprintf(stderr, "Analisi terminata: %zu sorgenti in %.3f secondi (%.0f sorgenti/s, %.1f milioni di archi/s).\n", state.sorgentiCompletate, elapsed,
+            elapsed > 0 ? state.sorgentiCompletate / elapsed : 0.0, elapsed > 0 ? state.archiEsaminati / elapsed / 1e6 : 0.0);
+
+    writeHistogram(&state, state.sorgentiCompletate);
+    writeEccentricity(&state);
+
+    xpthread_mutex_destroy(&state.mutex, LINEFILE);
+    free(workers);
+    free(state.sorgenti);
+    free(state.eccentricita);
+    free(state.esatta);
+    free(state.istogramma);
+}
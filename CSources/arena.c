@@ -0,0 +1,133 @@
+#define _GNU_SOURCE
+
+#include "../CHeaders/arena.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// I dati di un blocco iniziano subito dopo l'header, arrotondato all'allineamento
+#define ARENA_HEADER_SIZE ((sizeof(arenaBlock) + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1))
+
+/**
+ * @brief Restituisce l'inizio dell'area dati di un blocco.
+ * @param block Puntatore al blocco.
+ * @return Puntatore al primo byte utilizzabile.
+ */
+static char* blockData(arenaBlock* block) {
+    return (char*) block + ARENA_HEADER_SIZE;
+}
+
+/**
+ * @brief Alloca un nuovo blocco e lo rende il blocco corrente dell'arena.
+ * @param a Puntatore all'arena.
+ * @param minimum Byte che il blocco deve poter contenere.
+ */
+static void arenaGrow(arena* a, size_t minimum) {
+    size_t capacity = minimum > ARENA_BLOCK_SIZE ? minimum : ARENA_BLOCK_SIZE;
+
+    arenaBlock* block = malloc(ARENA_HEADER_SIZE + capacity);
+    if (block == NULL) xtermina(LINEFILE, "Allocazione di un blocco dell'arena fallita");
+
+    block -> next = a -> current;
+    block -> capacity = capacity;
+    block -> used = 0;
+    block -> last = 0;
+
+    a -> current = block;
+    a -> allocated += ARENA_HEADER_SIZE + capacity;
+}
+
+/**
+ * @brief Crea un'arena vuota, i blocchi vengono allocati alla prima richiesta.
+ * @details L'arena non è thread-safe: deve essere usata da un solo thread alla volta.
+ * @return Puntatore all'arena creata.
+ */
+arena* arenaCreate() {
+    arena* a = malloc(sizeof(arena));
+    if (a == NULL) xtermina(LINEFILE, "Allocazione dell'arena fallita");
+
+    a -> current = NULL;
+    a -> allocated = 0;
+
+    return a;
+}
+
+/**
+ * @brief Assegna una zona di memoria dall'arena spostando in avanti il puntatore del blocco corrente.
+ * @details La memoria non può essere liberata singolarmente, viene rilasciata tutta insieme da arenaFree().
+ *          Le richieste più grandi di ARENA_BLOCK_SIZE ricevono un blocco dedicato.
+ * @param a Puntatore all'arena.
+ * @param size Byte richiesti.
+ * @return Puntatore alla memoria, allineato ad ARENA_ALIGNMENT.
+ */
+void* arenaAlloc(arena* a, size_t size) {
+    if (!a) xtermina(LINEFILE, "arenaAlloc() eseguita su arena invalida");
+
+    size_t rounded = (size + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1);
+    if (rounded == 0) rounded = ARENA_ALIGNMENT;
+
+    arenaBlock* block = a -> current;
+    if (block == NULL || block -> capacity - block -> used < rounded) {
+        arenaGrow(a, rounded);
+        block = a -> current;
+    }
+
+    block -> last = block -> used;
+    block -> used += rounded;
+
+    return blockData(block) + block -> last;
+}
+
+/**
+ * @brief Assegna dall'arena un array azzerato.
+ * @param a Puntatore all'arena.
+ * @param n Numero di elementi.
+ * @param size Size di un elemento.
+ * @return Puntatore all'array azzerato.
+ */
+void* arenaCalloc(arena* a, size_t n, size_t size) {
+    if (size != 0 && n > SIZE_MAX / size) xtermina(LINEFILE, "Overflow nella size richiesta ad arenaCalloc()");
+
+    void* ptr = arenaAlloc(a, n * size);
+    memset(ptr, 0, n * size);
+
+    return ptr;
+}
+
+/**
+ * @brief Riduce l'ultima allocazione dell'arena, restituendo i byte in eccesso al blocco corrente.
+ * @details Utile quando la size viene stimata per eccesso, se ptr non è l'ultima allocazione non fa nulla.
+ * @param a Puntatore all'arena.
+ * @param ptr Puntatore restituito dall'ultima arenaAlloc().
+ * @param size Nuova size, non maggiore di quella richiesta.
+ */
+void arenaTrim(arena* a, void* ptr, size_t size) {
+    if (!a) xtermina(LINEFILE, "arenaTrim() eseguita su arena invalida");
+
+    arenaBlock* block = a -> current;
+    if (block == NULL || (char*) ptr != blockData(block) + block -> last) return;
+
+    size_t rounded = (size + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1);
+    if (rounded == 0) rounded = ARENA_ALIGNMENT;
+
+    if (block -> last + rounded < block -> used) block -> used = block -> last + rounded;
+}
+
+/**
+ * @brief Dealloca l'arena e tutta la memoria assegnata da essa.
+ * @param a Puntatore all'arena.
+ */
+void arenaFree(arena* a) {
+    if (!a) return;
+
+    arenaBlock* block = a -> current;
+    while (block != NULL) {
+        arenaBlock* next = block -> next;
+        free(block);
+        block = next;
+    }
+
+    free(a);
+}
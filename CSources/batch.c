@@ -0,0 +1,276 @@
+#define _GNU_SOURCE
+
+#include "../CHeaders/batch.h"
+#include "../CHeaders/msbfs.h"
+#include "../CHeaders/bfs.h"
+#include "../CHeaders/shortestPaths.h"
+#include "../CHeaders/tokenizer.h"
+#include "../CHeaders/utilities.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h> // Per PRId32
+#include <sys/times.h>
+
+/**
+ * @brief Compara due richieste per sorgente e poi per destinazione.
+ * @param x Puntatore alla prima richiesta.
+ * @param y Puntatore alla seconda richiesta.
+ * @return Negativo, zero o positivo come richiesto da qsort().
+ */
+static int compareQueries(const void* x, const void* y) {
+    const batchQuery* p = (const batchQuery*) x;
+    const batchQuery* q = (const batchQuery*) y;
+
+    if (p -> idA != q -> idA) return (p -> idA > q -> idA) - (p -> idA < q -> idA);
+    return (p -> idB > q -> idB) - (p -> idB < q -> idB);
+}
+
+/**
+ * @brief Legge le coppie di codici del file di batch, una coppia per linea separata da spazi o tab.
+ * @details Le coppie con un codice non valido, con a == b o con i nodi in componenti connesse diverse vengono risposte subito,
+ *          le altre vengono restituite.
+ * @param g Grafo degli attori.
+ * @param componenti Componenti connesse del grafo.
+ * @param risposte Pipe delle risposte (NULL se le risposte vanno nei file a.b).
+ * @param path Percorso del file (anche una named pipe).
+ * @param numQueries Impostato al numero di richieste valide restituite.
+ * @param numRequests Impostato al numero totale di coppie lette.
+ * @return Array delle richieste valide con a != b.
+ */
+static batchQuery* readQueries(grafo* g, const componentIndex* componenti, responseChannel* risposte, const char* path, size_t* numQueries, size_t* numRequests) {
+    size_t size;
+    char* text = readFile(path, &size);
+    const char* end = text + size;
+
+    batchQuery* queries = malloc((countByte(text, end, '\n') + 1) * sizeof(batchQuery));
+    if (queries == NULL) xtermina(LINEFILE, "Allocazione delle richieste del batch fallita");
+
+    // Buffer delle risposte date durante la lettura
+    textBuffer* buffer = textBufferCreate();
+
+    size_t count = 0, requests = 0, lineNumber = 0;
+    const char* line = text;
+
+    while (line < end) {
+        const char* lineEnd = findByte(line, end, '\n');
+        const char* p = line;
+        line = lineEnd + 1;
+        lineNumber++;
+
+        int a = 0, b = 0;
+        if (!nextInt(&p, lineEnd, &a)) {
+            while (p < lineEnd && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+            if (p == lineEnd) continue; // Linea vuota
+            xtermina(LINEFILE, "Linea %zu del file di batch %s mal formattata", lineNumber, path);
+        }
+        if (!nextInt(&p, lineEnd, &b)) xtermina(LINEFILE, "Linea %zu del file di batch %s mal formattata", lineNumber, path);
+
+        requests++;
+        clock_t timeStart = times(NULL);
+
+        int idA = nodeIndex(g, a);
+        int idB = nodeIndex(g, b);
+
+        if (idA == -1) writeInvalidResult(risposte, buffer, a, b, a, timeStart);
+        else if (idB == -1) writeInvalidResult(risposte, buffer, a, b, b, timeStart);
+        else if (a == b) writePathResult(g, risposte, buffer, a, b, &idA, 1, timeStart);
+        else if (!componentsConnected(componenti, idA, idB)) writePathResult(g, risposte, buffer, a, b, NULL, 0, timeStart);
+        else queries[count++] = (batchQuery) { .a = a, .b = b, .idA = idA, .idB = idB };
+    }
+
+    free(text);
+    freeTextBuffer(buffer);
+
+    *numQueries = count;
+    *numRequests = requests;
+    return queries;
+}
+
+/**
+ * @brief Divide le richieste, ordinate per sorgente, in lotti di al più MSBFS_WIDTH sorgenti distinte.
+ * @param queries Richieste ordinate per sorgente.
+ * @param numQueries Numero di richieste.
+ * @param numLots Impostato al numero di lotti.
+ * @param numSources Impostato al numero totale di sorgenti distinte.
+ * @return Array dei lotti.
+ */
+static batchLot* splitLots(const batchQuery* queries, size_t numQueries, size_t* numLots, size_t* numSources) {
+    batchLot* lots = malloc((numQueries / MSBFS_WIDTH + 1) * sizeof(batchLot));
+    if (lots == NULL) xtermina(LINEFILE, "Allocazione dei lotti del batch fallita");
+
+    size_t count = 0, sources = 0;
+
+    for (size_t i = 0; i < numQueries; i++) {
+        bool newSource = i == 0 || queries[i].idA != queries[i - 1].idA;
+
+        if (i == 0 || (newSource && lots[count - 1].numSources == MSBFS_WIDTH)) {
+            lots[count].first = i;
+            lots[count].numSources = 0;
+            count++;
+        }
+
+        if (newSource) {
+            lots[count - 1].numSources++;
+            sources++;
+        }
+
+        lots[count - 1].last = i + 1;
+    }
+
+    *numLots = count;
+    *numSources = sources;
+    return lots;
+}
+
+/**
+ * @brief Risponde a tutte le richieste di un lotto con un'unica BFS multi-sorgente.
+ * @param state Stato condiviso del batch.
+ * @param lot Lotto da elaborare.
+ * @param ms Contesto della BFS multi-sorgente del worker.
+ * @param ctx Contesto di ricerca del worker, usato solo oltre MSBFS_MAX_LEVEL livelli.
+ * @param sources Array di MSBFS_WIDTH elementi per le sorgenti del lotto.
+ * @param targets Array di almeno lot -> last - lot -> first elementi per i nodi da raggiungere.
+ */
+static void processLot(batchState* state, const batchLot* lot, msbfsContext* ms, bfsContext* ctx, int* sources, msbfsTarget* targets) {
+    grafo* g = state -> g;
+    clock_t timeStart = times(NULL);
+
+    // Sorgenti distinte del lotto e, per ogni richiesta, il bit della sua sorgente
+    int numSources = 0;
+
+    for (size_t i = lot -> first; i < lot -> last; i++) {
+        const batchQuery* q = &(state -> queries)[i];
+
+        if (numSources == 0 || sources[numSources - 1] != q -> idA) sources[numSources++] = q -> idA;
+
+        targets[i - lot -> first].source = numSources - 1;
+        targets[i - lot -> first].node = q -> idB;
+    }
+
+    msbfsRun(g, ms, sources, numSources, targets, lot -> last - lot -> first);
+
+    for (size_t i = lot -> first; i < lot -> last; i++) {
+        const batchQuery* q = &(state -> queries)[i];
+        int source = targets[i - lot -> first].source;
+        size_t length;
+
+        if (msbfsDistance(ms, source, q -> idB) != MSBFS_UNREACHED) {
+            length = msbfsExtractPath(g, ms, source, q -> idB, ctx -> path);
+        }
+        else if (msbfsReached(ms, source, q -> idB)) {
+            // Distanza oltre MSBFS_MAX_LEVEL: non memorizzabile in un uint8_t, ricerca singola
+            length = findShortestPath(g, ctx, q -> idA, q -> idB, state -> opts -> modalitaRicerca) ? bfsExtractPath(ctx, q -> idB) : 0;
+        }
+        else length = 0;
+
+        writePathResult(g, state -> risposte, ctx -> output, q -> a, q -> b, ctx -> path, length, timeStart);
+    }
+}
+
+/**
+ * @brief Funzione eseguita dai worker del batch: prelevano un lotto alla volta finché non sono finiti.
+ * @param arg Puntatore allo stato condiviso del batch.
+ */
+void* batchWorkerBody(void* arg) {
+    batchState* state = (batchState*) arg;
+
+    // Buffer di lavoro del worker, allocati una sola volta per tutti i lotti
+    msbfsContext* ms = msbfsContextCreate(state -> g -> numNodi);
+    bfsContext* ctx = bfsContextCreate(state -> g -> numNodi);
+    int sources[MSBFS_WIDTH];
+    msbfsTarget* targets = NULL;
+    size_t targetsCapacity = 0;
+
+    while (true) {
+        // Zona critica
+        xpthread_mutex_lock(&state -> mutex, LINEFILE);
+
+        size_t index = state -> nextLot;
+        if (index < state -> numLots && !(*(state -> mustShutdown))) state -> nextLot++;
+        else index = state -> numLots;
+
+        xpthread_mutex_unlock(&state -> mutex, LINEFILE);
+        // Fine zona critica
+
+        if (index == state -> numLots) break;
+
+        const batchLot* lot = &(state -> lots)[index];
+        size_t numTargets = lot -> last - lot -> first;
+
+        if (numTargets > targetsCapacity) {
+            targetsCapacity = numTargets;
+            free(targets);
+            targets = malloc(targetsCapacity * sizeof(msbfsTarget));
+            if (targets == NULL) xtermina(LINEFILE, "Allocazione dei nodi da raggiungere del batch fallita");
+        }
+
+        processLot(state, lot, ms, ctx, sources, targets);
+    }
+
+    free(targets);
+    bfsContextFree(ctx);
+    msbfsContextFree(ms);
+
+    pthread_exit(NULL);
+}
+
+/**
+ * @brief Modalità batch: risponde a tutte le coppie del file passato con --batch, scrivendo i soliti file a.b
+ * @details Le richieste vengono ordinate per sorgente e divise in lotti di MSBFS_WIDTH sorgenti distinte, ogni lotto
+ *          viene risolto con un'unica BFS multi-sorgente che condivide la scansione degli archi tra tutte le sue sorgenti.
+ *          I lotti vengono distribuiti tra opts -> numThread worker, al più quanti ne entrano in BATCH_MEMORY_BUDGET.
+ *          All'arrivo di SIGINT i lotti non iniziati vengono saltati.
+ * @param g Grafo degli attori.
+ * @param componenti Componenti connesse del grafo.
+ * @param risposte Pipe delle risposte (NULL se le risposte vanno nei file a.b).
+ * @param opts Opzioni passate da linea di comando.
+ * @param mustShutdown Booleano per gestire l'arrivo di SIGINT.
+ */
+void runBatch(grafo* g, const componentIndex* componenti, responseChannel* risposte, const opzioni* opts, volatile bool* mustShutdown) {
+    clock_t timeStart = times(NULL);
+
+    fprintf(stderr, "Inizio batch da %s.\n", opts -> fileBatch);
+
+    size_t numQueries, numRequests, numSources;
+    batchQuery* queries = readQueries(g, componenti, risposte, opts -> fileBatch, &numQueries, &numRequests);
+
+    qsort(queries, numQueries, sizeof(batchQuery), compareQueries);
+
+    batchState state;
+    state.g = g;
+    state.opts = opts;
+    state.risposte = risposte;
+    state.queries = queries;
+    state.lots = splitLots(queries, numQueries, &state.numLots, &numSources);
+    state.nextLot = 0;
+    state.mustShutdown = mustShutdown;
+    xpthread_mutex_init(&state.mutex, NULL, LINEFILE);
+
+    // Ogni worker ha un contesto MS-BFS e uno di ricerca dimensionati sul grafo: su grafi grandi il numero di worker
+    // viene limitato così che i loro buffer restino entro BATCH_MEMORY_BUDGET, invece di crescere con --thread
+    size_t workerBytes = msbfsContextBytes(g -> numNodi) + bfsContextBytes(g -> numNodi);
+    size_t maxWorkers = BATCH_MEMORY_BUDGET / workerBytes > 0 ? BATCH_MEMORY_BUDGET / workerBytes : 1;
+
+    size_t numWorkers = opts -> numThread < state.numLots ? opts -> numThread : state.numLots;
+    if (numWorkers > maxWorkers) {
+        fprintf(stderr, "Worker del batch limitati a %zu (%zu MiB ciascuno, massimo %zu MiB in totale).\n",
+                maxWorkers, workerBytes >> 20, BATCH_MEMORY_BUDGET >> 20);
+        numWorkers = maxWorkers;
+    }
+    pthread_t* workers = malloc((numWorkers > 0 ? numWorkers : 1) * sizeof(pthread_t));
+    if (workers == NULL) xtermina(LINEFILE, "Allocazione dei worker del batch fallita");
+
+    for (size_t i = 0; i < numWorkers; i++) xpthread_create(&workers[i], NULL, &batchWorkerBody, &state, LINEFILE);
+    for (size_t i = 0; i < numWorkers; i++) xpthread_join(workers[i], NULL, LINEFILE);
+
+    fprintf(stderr, "Batch terminato: %zu richieste, %zu sorgenti distinte in %zu lotti (%zu elaborati) con %zu worker. Tempo %.3f secondi.\n",
+            numRequests, numSources, state.numLots, state.nextLot, numWorkers, (double)(times(NULL) - timeStart) / sysconf(_SC_CLK_TCK));
+
+    xpthread_mutex_destroy(&state.mutex, LINEFILE);
+    free(workers);
+    free(state.lots);
+    free(queries);
+}
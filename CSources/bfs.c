@@ -0,0 +1,801 @@
+#define _GNU_SOURCE
+
+#include "../CHeaders/bfs.h"
+#include "../CHeaders/dataStructures.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Crea un contesto di ricerca riutilizzabile dimensionato sul numero di nodi del grafo.
+ * @param n Numero di nodi del grafo.
+ * @return Puntatore al contesto creato.
+ */
+bfsContext* bfsContextCreate(size_t n) {
+    bfsContext* ctx = malloc(sizeof(bfsContext));
+    if (ctx == NULL) xtermina(LINEFILE, "Allocazione del contesto di ricerca fallita");
+
+    ctx -> visited = calloc(n > 0 ? n : 1, sizeof(uint32_t));
+    ctx -> parents = malloc((n > 0 ? n : 1) * sizeof(int));
+    ctx -> successors = malloc((n > 0 ? n : 1) * sizeof(int));
+    ctx -> path = malloc((n > 0 ? n : 1) * sizeof(int));
+    ctx -> depth = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (ctx -> visited == NULL || ctx -> parents == NULL || ctx -> successors == NULL || ctx -> path == NULL || ctx -> depth == NULL) xtermina(LINEFILE, "Allocazione degli array del contesto di ricerca fallita");
+
+    ctx -> epoch = 0;
+    ctx -> queue = queueCreate();
+    ctx -> queueBackward = queueCreate();
+    for (int i = 0; i < 3; i++) ctx -> buckets[i] = queueCreate();
+    ctx -> landmarks = NULL;
+    ctx -> output = textBufferCreate();
+    ctx -> sigma = NULL;
+    ctx -> cursors = NULL;
+    ctx -> meetings = NULL;
+    ctx -> meetingsCapacity = 0;
+
+    size_t words = (n + 63) / 64;
+    ctx -> frontier = calloc(words > 0 ? words : 1, sizeof(uint64_t));
+    ctx -> nextFrontier = calloc(words > 0 ? words : 1, sizeof(uint64_t));
+    if (ctx -> frontier == NULL || ctx -> nextFrontier == NULL) xtermina(LINEFILE, "Allocazione delle bitmap del contesto di ricerca fallita");
+
+    ctx -> size = n;
+
+    return ctx;
+}
+
+/**
+ * @brief Memoria occupata dagli array di un contesto di ricerca, senza le code e i buffer che crescono durante l'uso.
+ * @param n Numero di nodi del grafo.
+ * @return Byte allocati da bfsContextCreate(n) per gli array per nodo e le bitmap.
+ */
+size_t bfsContextBytes(size_t n) {
+    size_t size = n > 0 ? n : 1;
+    size_t words = (n + 63) / 64;
+
+    return size * (sizeof(uint32_t) + 4 * sizeof(int)) + 2 * (words > 0 ? words : 1) * sizeof(uint64_t);
+}
+
+/**
+ * @brief Dealloca un contesto di ricerca.
+ * @param ctx Puntatore al contesto.
+ */
+void bfsContextFree(bfsContext* ctx) {
+    if (!ctx) return;
+
+    free(ctx -> visited);
+    free(ctx -> parents);
+    free(ctx -> successors);
+    free(ctx -> path);
+    free(ctx -> depth);
+    freeQueue(ctx -> queue);
+    freeQueue(ctx -> queueBackward);
+    for (int i = 0; i < 3; i++) freeQueue(ctx -> buckets[i]);
+    free(ctx -> frontier);
+    free(ctx -> nextFrontier);
+    freeTextBuffer(ctx -> output);
+    free(ctx -> sigma);
+    free(ctx -> cursors);
+    free(ctx -> meetings);
+    free(ctx);
+}
+
+/**
+ * @brief Prepara il contesto per una nuova ricerca in tempo O(1).
+ * @details Incrementa l'epoca di 2 (un valore per lato della ricerca bidirezionale), così tutti i nodi
+ *          marcati con epoche precedenti risultano non visitati.
+ *          L'array visited viene azzerato solo quando l'epoca torna a 0 dopo 2^31 ricerche.
+ * @param ctx Puntatore al contesto.
+ */
+void bfsNewSearch(bfsContext* ctx) {
+    ctx -> epoch += 2;
+
+    if (ctx -> epoch == 0) {
+        memset(ctx -> visited, 0, ctx -> size * sizeof(uint32_t));
+        ctx -> epoch = 2;
+    }
+
+    queueClear(ctx -> queue);
+    queueClear(ctx -> queueBackward);
+    for (int i = 0; i < 3; i++) queueClear(ctx -> buckets[i]);
+}
+
+/**
+ * @brief BFS da start fino a target, riempie l'array dei genitori del contesto.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto di ricerca del thread chiamante.
+ * @param start Id denso dell'attore iniziale.
+ * @param target Id denso dell'attore destinazione.
+ * @return true se esiste un cammino, false altrimenti.
+ */
+bool bfsShortestPath(grafo* g, bfsContext* ctx, int start, int target) {
+    bfsNewSearch(ctx);
+
+    uint32_t epoch = ctx -> epoch;
+    uint32_t* visited = ctx -> visited;
+    int* parents = ctx -> parents;
+
+    // Aggiunge start senza genitore
+    visited[start] = epoch;
+    parents[start] = -1;
+    enqueue(ctx -> queue, start);
+
+    while (!queueIsEmpty(ctx -> queue)) {
+        int currentId = dequeue(ctx -> queue);
+
+        // Scorre i coprotagonisti
+        for (size_t i = g -> offsets[currentId]; i < g -> offsets[currentId + 1]; i++) {
+            int coprotId = g -> vicini[i];
+
+            // Se attore già esplorato salta
+            if (visited[coprotId] == epoch) continue;
+
+            visited[coprotId] = epoch;
+            parents[coprotId] = currentId;
+
+            // Se trova target ha finito
+            if (coprotId == target) return true;
+
+            enqueue(ctx -> queue, coprotId);
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Ricollega i due lati della ricerca bidirezionale nell'array dei genitori.
+ * @details Dopo la chiamata parents descrive l'intero cammino da start a target, quindi può essere
+ *          estratto con bfsExtractPath() come per la BFS unidirezionale.
+ * @param ctx Contesto di ricerca.
+ * @param forwardNode Nodo del lato di start sull'arco di incontro.
+ * @param backwardNode Nodo del lato di target sull'arco di incontro.
+ */
+static void joinPaths(bfsContext* ctx, int forwardNode, int backwardNode) {
+    int current = backwardNode;
+    ctx -> parents[current] = forwardNode;
+
+    // Percorre i successori fino a target invertendone il verso
+    while (ctx -> successors[current] != -1) {
+        int next = ctx -> successors[current];
+        ctx -> parents[next] = current;
+        current = next;
+    }
+}
+
+/**
+ * @brief Controlla se l'anno di nascita di un nodo rispetta il vincolo di una ricerca.
+ * @param g Grafo degli attori.
+ * @param filter Vincolo sugli anni di nascita.
+ * @param id Id denso del nodo.
+ * @return true se il nodo può far parte del cammino.
+ */
+static inline bool yearAllowed(const grafo* g, const yearFilter* filter, int id) {
+    return g -> anni[id] >= filter -> annoMin && g -> anni[id] <= filter -> annoMax;
+}
+
+/**
+ * @brief Espande un intero livello di uno dei due lati della ricerca bidirezionale.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto di ricerca.
+ * @param queue Coda del lato da espandere.
+ * @param links Array dei collegamenti del lato (parents per start, successors per target).
+ * @param mine Marcatore dei nodi visitati dal lato espanso.
+ * @param other Marcatore dei nodi visitati dall'altro lato.
+ * @param filter Intervallo degli anni di nascita dei nodi che possono essere scoperti (NULL per nessun vincolo).
+ * @param meetFrom Impostato al nodo del lato espanso sull'arco di incontro.
+ * @param meetTo Impostato al nodo dell'altro lato sull'arco di incontro.
+ * @return true se i due lati si sono incontrati, false altrimenti.
+ */
+static bool expandLevel(grafo* g, bfsContext* ctx, circularQueue* queue, int* links, uint32_t mine, uint32_t other, const yearFilter* filter, int* meetFrom, int* meetTo) {
+    uint32_t* visited = ctx -> visited;
+    size_t levelSize = queue -> size;
+
+    for (size_t k = 0; k < levelSize; k++) {
+        int currentId = dequeue(queue);
+
+        for (size_t i = g -> offsets[currentId]; i < g -> offsets[currentId + 1]; i++) {
+            int coprotId = g -> vicini[i];
+
+            if (visited[coprotId] == mine) continue;
+
+            // Nodo già raggiunto dall'altro lato: il primo incontro durante un livello è a distanza minima
+            if (visited[coprotId] == other) {
+                *meetFrom = currentId;
+                *meetTo = coprotId;
+                return true;
+            }
+
+            // Gli estremi sono già visitati dal proprio lato, il vincolo riguarda solo i nodi intermedi
+            if (filter != NULL && !yearAllowed(g, filter, coprotId)) continue;
+
+            visited[coprotId] = mine;
+            links[coprotId] = currentId;
+            enqueue(queue, coprotId);
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief BFS bidirezionale tra start e target, con un eventuale vincolo sugli anni di nascita dei nodi intermedi.
+ * @details Ad ogni passo espande un intero livello del lato con la frontiera più piccola,
+ *          quando i due lati si incontrano il cammino viene ricucito con joinPaths().
+ * @param g Grafo degli attori.
+ * @param ctx Contesto di ricerca del thread chiamante.
+ * @param start Id denso dell'attore iniziale.
+ * @param target Id denso dell'attore destinazione.
+ * @param filter Vincolo sugli anni di nascita (NULL per nessun vincolo).
+ * @return true se esiste un cammino, false altrimenti.
+ */
+static bool bidirectionalSearch(grafo* g, bfsContext* ctx, int start, int target, const yearFilter* filter) {
+    bfsNewSearch(ctx);
+
+    uint32_t forward = ctx -> epoch;
+    uint32_t backward = ctx -> epoch + 1;
+
+    ctx -> visited[start] = forward;
+    ctx -> parents[start] = -1;
+    enqueue(ctx -> queue, start);
+
+    if (start == target) return true;
+
+    ctx -> visited[target] = backward;
+    ctx -> successors[target] = -1;
+    enqueue(ctx -> queueBackward, target);
+
+    int meetFrom, meetTo;
+
+    while (!queueIsEmpty(ctx -> queue) && !queueIsEmpty(ctx -> queueBackward)) {
+        if (ctx -> queue -> size <= ctx -> queueBackward -> size) {
+            if (expandLevel(g, ctx, ctx -> queue, ctx -> parents, forward, backward, filter, &meetFrom, &meetTo)) {
+                joinPaths(ctx, meetFrom, meetTo);
+                return true;
+            }
+        } else {
+            if (expandLevel(g, ctx, ctx -> queueBackward, ctx -> successors, backward, forward, filter, &meetFrom, &meetTo)) {
+                joinPaths(ctx, meetTo, meetFrom);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief BFS bidirezionale tra start e target, riempie l'array dei genitori del contesto.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto di ricerca del thread chiamante.
+ * @param start Id denso dell'attore iniziale.
+ * @param target Id denso dell'attore destinazione.
+ * @return true se esiste un cammino, false altrimenti.
+ */
+bool bfsBidirectional(grafo* g, bfsContext* ctx, int start, int target) {
+    return bidirectionalSearch(g, ctx, start, target, NULL);
+}
+
+/**
+ * @brief Cammino minimo tra start e target i cui nodi intermedi sono nati negli anni del vincolo.
+ * @details Usa sempre la ricerca bidirezionale: i nodi fuori dal vincolo vengono saltati durante la scansione dei vicini
+ *          confrontando l'array denso degli anni del grafo, come se non esistessero, senza costruire un sottografo.
+ *          La ricerca costa quindi quanto una senza vincolo, o meno dato che visita meno nodi.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto di ricerca del thread chiamante.
+ * @param start Id denso dell'attore iniziale.
+ * @param target Id denso dell'attore destinazione.
+ * @param filter Vincolo sugli anni di nascita dei nodi intermedi.
+ * @return true se esiste un cammino, false altrimenti. In caso positivo il cammino è descritto da ctx -> parents.
+ */
+bool bfsConstrainedPath(grafo* g, bfsContext* ctx, int start, int target, const yearFilter* filter) {
+    return bidirectionalSearch(g, ctx, start, target, filter);
+}
+
+/**
+ * @brief Passo bottom-up: ogni nodo non visitato cerca un genitore tra i suoi vicini nella frontiera.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto di ricerca, la frontiera corrente è in ctx -> frontier.
+ * @param target Id denso dell'attore destinazione.
+ * @param frontierEdges Impostato alla somma dei gradi dei nodi della nuova frontiera.
+ * @param found Impostato a true se target è stato raggiunto.
+ * @return Numero di nodi della nuova frontiera (in ctx -> nextFrontier).
+ */
+static size_t bottomUpStep(grafo* g, bfsContext* ctx, int target, size_t* frontierEdges, bool* found) {
+    uint32_t epoch = ctx -> epoch;
+    uint64_t* frontier = ctx -> frontier;
+    uint64_t* next = ctx -> nextFrontier;
+    size_t count = 0, edges = 0;
+
+    memset(next, 0, ((g -> numNodi + 63) / 64) * sizeof(uint64_t));
+
+    for (size_t v = 0; v < g -> numNodi; v++) {
+        if (ctx -> visited[v] == epoch) continue;
+
+        for (size_t i = g -> offsets[v]; i < g -> offsets[v + 1]; i++) {
+            int u = g -> vicini[i];
+
+            if (frontier[u >> 6] & (1ULL << (u & 63))) {
+                ctx -> visited[v] = epoch;
+                ctx -> parents[v] = u;
+                next[v >> 6] |= 1ULL << (v & 63);
+                count++;
+                edges += g -> offsets[v + 1] - g -> offsets[v];
+
+                if ((int) v == target) {
+                    *found = true;
+                    return count;
+                }
+
+                break;
+            }
+        }
+    }
+
+    *frontierEdges = edges;
+    return count;
+}
+
+/**
+ * @brief BFS direction-optimizing da start fino a target, riempie l'array dei genitori del contesto.
+ * @details Finché la frontiera è piccola espande in top-down dalla coda, quando gli archi uscenti dalla frontiera
+ *          superano una frazione di quelli dei nodi non esplorati passa a passi bottom-up su una bitmap,
+ *          in cui ogni nodo non visitato si ferma al primo vicino trovato nella frontiera.
+ *          Riduce gli archi esaminati nei livelli centrali della ricerca e quando target non è raggiungibile.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto di ricerca del thread chiamante.
+ * @param start Id denso dell'attore iniziale.
+ * @param target Id denso dell'attore destinazione.
+ * @return true se esiste un cammino, false altrimenti.
+ */
+bool bfsDirectionOptimizing(grafo* g, bfsContext* ctx, int start, int target) {
+    bfsNewSearch(ctx);
+
+    uint32_t epoch = ctx -> epoch;
+    size_t words = (g -> numNodi + 63) / 64;
+
+    ctx -> visited[start] = epoch;
+    ctx -> parents[start] = -1;
+    enqueue(ctx -> queue, start);
+
+    if (start == target) return true;
+
+    size_t frontierSize = 1;
+    size_t frontierEdges = g -> offsets[start + 1] - g -> offsets[start];
+    size_t unexploredEdges = g -> numArchi - frontierEdges;
+    bool topDown = true;
+
+    while (frontierSize > 0) {
+        if (topDown && frontierEdges > unexploredEdges / BFS_ALPHA) {
+            // Coda -> bitmap
+            memset(ctx -> frontier, 0, words * sizeof(uint64_t));
+            while (!queueIsEmpty(ctx -> queue)) {
+                int u = dequeue(ctx -> queue);
+                ctx -> frontier[u >> 6] |= 1ULL << (u & 63);
+            }
+            topDown = false;
+        } else if (!topDown && frontierSize < g -> numNodi / BFS_BETA) {
+            // Bitmap -> coda
+            for (size_t w = 0; w < words; w++) {
+                uint64_t bits = ctx -> frontier[w];
+                while (bits) {
+                    enqueue(ctx -> queue, (int) (w * 64 + __builtin_ctzll(bits)));
+                    bits &= bits - 1;
+                }
+            }
+            topDown = true;
+        }
+
+        size_t nextSize = 0, nextEdges = 0;
+
+        if (topDown) {
+            size_t levelSize = ctx -> queue -> size;
+
+            for (size_t k = 0; k < levelSize; k++) {
+                int currentId = dequeue(ctx -> queue);
+
+                for (size_t i = g -> offsets[currentId]; i < g -> offsets[currentId + 1]; i++) {
+                    int coprotId = g -> vicini[i];
+                    if (ctx -> visited[coprotId] == epoch) continue;
+
+                    ctx -> visited[coprotId] = epoch;
+                    ctx -> parents[coprotId] = currentId;
+                    if (coprotId == target) return true;
+
+                    enqueue(ctx -> queue, coprotId);
+                    nextSize++;
+                    nextEdges += g -> offsets[coprotId + 1] - g -> offsets[coprotId];
+                }
+            }
+        } else {
+            bool found = false;
+            nextSize = bottomUpStep(g, ctx, target, &nextEdges, &found);
+            if (found) return true;
+
+            uint64_t* temp = ctx -> frontier;
+            ctx -> frontier = ctx -> nextFrontier;
+            ctx -> nextFrontier = temp;
+        }
+
+        frontierSize = nextSize;
+        frontierEdges = nextEdges;
+        unexploredEdges = unexploredEdges > nextEdges ? unexploredEdges - nextEdges : 0;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Ricerca A* da start a target guidata dai landmark, riempie l'array dei genitori del contesto.
+ * @details L'euristica h(v) = max |d(L, v) - d(L, target)| è ammissibile e consistente e varia al più di 1 tra nodi
+ *          adiacenti, quindi con archi di costo unitario f = depth + h di un vicino vale f, f + 1 o f + 2 del nodo
+ *          espanso: bastano tre code indicizzate da f modulo 3 invece di una coda con priorità. Per la consistenza
+ *          un nodo estratto per la prima volta ha già la distanza minima, le estrazioni successive vengono ignorate.
+ *          I nodi chiusi sono marcati con epoch + 1, quelli scoperti con epoch.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto di ricerca del thread chiamante, con un indice dei landmark non saturo.
+ * @param start Id denso dell'attore iniziale.
+ * @param target Id denso dell'attore destinazione.
+ * @return true se esiste un cammino, false altrimenti.
+ */
+bool bfsAStar(grafo* g, bfsContext* ctx, int start, int target) {
+    bfsNewSearch(ctx);
+
+    const landmarkIndex* index = ctx -> landmarks;
+    const uint8_t* targetRow = index -> dist + (size_t) target * index -> k;
+
+    uint32_t open = ctx -> epoch, closed = ctx -> epoch + 1;
+    uint32_t* visited = ctx -> visited;
+
+    int h = landmarkHeuristic(index, start, targetRow);
+    if (h == LANDMARK_NO_PATH) return false; // Componenti diverse, nessuna ricerca
+
+    visited[start] = open;
+    ctx -> parents[start] = -1;
+    ctx -> depth[start] = 0;
+    enqueue(ctx -> buckets[h % 3], start);
+
+    int f = h; // Valore di f del livello in estrazione
+
+    while (true) {
+        // Il prossimo nodo ha f, f + 1 o f + 2
+        int step = 0;
+        while (step < 3 && queueIsEmpty(ctx -> buckets[(f + step) % 3])) step++;
+        if (step == 3) return false;
+
+        f += step;
+        int v = dequeue(ctx -> buckets[f % 3]);
+
+        if (visited[v] == closed) continue; // Estrazione già avvenuta con una distanza minore
+        visited[v] = closed;
+
+        if (v == target) return true;
+
+        int depth = ctx -> depth[v] + 1;
+
+        for (size_t i = g -> offsets[v]; i < g -> offsets[v + 1]; i++) {
+            int u = g -> vicini[i];
+
+            if (visited[u] == closed) continue;
+            if (visited[u] == open && ctx -> depth[u] <= depth) continue;
+
+            int hu = landmarkHeuristic(index, u, targetRow);
+            if (hu == LANDMARK_NO_PATH) continue;
+
+            visited[u] = open;
+            ctx -> depth[u] = depth;
+            ctx -> parents[u] = v;
+            enqueue(ctx -> buckets[(depth + hu) % 3], u);
+        }
+    }
+}
+
+/**
+ * @brief Calcola un cammino minimo tra start e target con l'algoritmo scelto.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto di ricerca del thread chiamante.
+ * @param start Id denso dell'attore iniziale.
+ * @param target Id denso dell'attore destinazione.
+ * @param mode Algoritmo di ricerca da usare.
+ * @return true se esiste un cammino, false altrimenti. In caso positivo il cammino è descritto da ctx -> parents.
+ */
+bool findShortestPath(grafo* g, bfsContext* ctx, int start, int target, bfsMode mode) {
+    // Senza un indice dei landmark affidabile A* ripiega sulla ricerca bidirezionale
+    if (mode == BFS_ASTAR && (ctx -> landmarks == NULL || ctx -> landmarks -> saturo)) mode = BFS_BIDIREZIONALE;
+
+    switch (mode) {
+        case BFS_ASTAR: return bfsAStar(g, ctx, start, target);
+        case BFS_BIDIREZIONALE: return bfsBidirectional(g, ctx, start, target);
+        case BFS_DIREZIONALE: return bfsDirectionOptimizing(g, ctx, start, target);
+        case BFS_UNIDIREZIONALE:
+        default: return bfsShortestPath(g, ctx, start, target);
+    }
+}
+
+/**
+ * @brief Estrae nell'array path del contesto il cammino trovato dall'ultima ricerca, da start a target.
+ * @param ctx Contesto dell'ultima ricerca andata a buon fine.
+ * @param target Id denso del nodo destinazione.
+ * @return Numero di nodi del cammino.
+ */
+size_t bfsExtractPath(bfsContext* ctx, int target) {
+    size_t length = 0;
+
+    // Risale i genitori da target a start
+    for (int current = target; current != -1; current = ctx -> parents[current]) ctx -> path[length++] = current;
+
+    // Inverte il cammino sul posto
+    for (size_t i = 0; i < length / 2; i++) {
+        int tmp = ctx -> path[i];
+        ctx -> path[i] = ctx -> path[length - 1 - i];
+        ctx -> path[length - 1 - i] = tmp;
+    }
+
+    return length;
+}
+
+/**
+ * @brief BFS completa da start, senza destinazione: al termine visited[v] == epoch per ogni nodo raggiungibile
+ *        e l'array dei genitori descrive l'intero albero BFS.
+ * @details Usa la BFS direction-optimizing, che su una visita completa sfrutta al massimo i passi bottom-up.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto di ricerca del thread chiamante.
+ * @param start Id denso della sorgente.
+ */
+void bfsFullTree(grafo* g, bfsContext* ctx, int start) {
+    bfsDirectionOptimizing(g, ctx, start, -1); // Nessun nodo ha id -1, la visita non termina in anticipo
+}
+
+/**
+ * @brief Somma a total il prodotto x * y, saturando a UINT64_MAX invece di andare in overflow.
+ * @param total Somma da aggiornare.
+ * @param x Primo fattore.
+ * @param y Secondo fattore.
+ * @return true se il risultato è stato saturato.
+ */
+static bool addProduct(uint64_t* total, uint64_t x, uint64_t y) {
+    uint64_t product;
+
+    if (__builtin_mul_overflow(x, y, &product) || __builtin_add_overflow(*total, product, total)) {
+        *total = UINT64_MAX;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Espande un intero livello di un lato della ricerca con conteggio dei cammini minimi.
+ * @details Come expandLevel(), ma un nodo già scoperto allo stesso livello riceve anche i cammini del nodo corrente
+ *          e l'incontro con l'altro lato non interrompe la scansione: tutti gli archi di incontro del livello
+ *          contribuiscono al conteggio, i primi maxMeetings vengono memorizzati per l'enumerazione.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto di ricerca.
+ * @param queue Coda del lato da espandere.
+ * @param mine Marcatore dei nodi visitati dal lato espanso.
+ * @param other Marcatore dei nodi visitati dall'altro lato.
+ * @param fromStart true se il lato espanso è quello di start.
+ * @param filter Vincolo sugli anni di nascita dei nodi intermedi (NULL per nessun vincolo).
+ * @param maxMeetings Numero massimo di archi di incontro da memorizzare.
+ * @param e Enumeratore in cui accumulare conteggio e archi di incontro.
+ * @return true se i due lati si sono incontrati, false altrimenti.
+ */
+static bool expandCountingLevel(grafo* g, bfsContext* ctx, circularQueue* queue, uint32_t mine, uint32_t other, bool fromStart, const yearFilter* filter, size_t maxMeetings, pathEnumerator* e) {
+    uint32_t* visited = ctx -> visited;
+    uint64_t* sigma = ctx -> sigma;
+    size_t levelSize = queue -> size;
+    bool met = false;
+
+    for (size_t k = 0; k < levelSize; k++) {
+        int currentId = dequeue(queue);
+        int nextDepth = ctx -> depth[currentId] + 1;
+
+        for (size_t i = g -> offsets[currentId]; i < g -> offsets[currentId + 1]; i++) {
+            int coprotId = g -> vicini[i];
+
+            if (visited[coprotId] == other) {
+                met = true;
+                if (addProduct(&e -> numCammini, sigma[currentId], sigma[coprotId])) e -> saturo = true;
+
+                if (e -> numIncontri < maxMeetings) {
+                    ctx -> meetings[2 * e -> numIncontri] = fromStart ? currentId : coprotId;
+                    ctx -> meetings[2 * e -> numIncontri + 1] = fromStart ? coprotId : currentId;
+                    e -> numIncontri++;
+                }
+            }
+            else if (visited[coprotId] != mine) {
+                if (filter != NULL && !yearAllowed(g, filter, coprotId)) continue;
+
+                visited[coprotId] = mine;
+                ctx -> depth[coprotId] = nextDepth;
+                sigma[coprotId] = sigma[currentId];
+                enqueue(queue, coprotId);
+            }
+            else if (ctx -> depth[coprotId] == nextDepth) {
+                // Altro cammino minimo verso un nodo già scoperto a questo livello
+                if (__builtin_add_overflow(sigma[coprotId], sigma[currentId], &sigma[coprotId])) sigma[coprotId] = UINT64_MAX;
+            }
+        }
+    }
+
+    return met;
+}
+
+/**
+ * @brief BFS bidirezionale che conta tutti i cammini minimi tra start e target e prepara la loro enumerazione.
+ * @details Ogni lato calcola per i propri nodi la distanza (ctx -> depth) e il numero di cammini minimi (ctx -> sigma).
+ *          Prima del livello in cui i lati si incontrano nessun nodo è condiviso, quindi ogni cammino minimo attraversa
+ *          esattamente un arco tra la frontiera di start (livello Lf) e quella di target (livello Lb): il numero di cammini
+ *          è la somma su questi archi dei prodotti dei sigma dei due estremi e la distanza è Lf + Lb + 1.
+ *          Non vengono memorizzate liste di predecessori: l'enumerazione li riconosce dalle distanze, quindi la memoria
+ *          resta O(numNodi) anche con nodi di grado molto alto e moltissimi cammini.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto di ricerca del thread chiamante, start != target.
+ * @param start Id denso dell'attore iniziale.
+ * @param target Id denso dell'attore destinazione.
+ * @param filter Vincolo sugli anni di nascita dei nodi intermedi (NULL per nessun vincolo).
+ * @param maxPaths Numero massimo di cammini che verranno enumerati.
+ * @param e Enumeratore da inizializzare.
+ * @return true se esiste un cammino, false altrimenti.
+ */
+bool bfsCountPaths(grafo* g, bfsContext* ctx, int start, int target, const yearFilter* filter, size_t maxPaths, pathEnumerator* e) {
+    if (ctx -> sigma == NULL) {
+        ctx -> sigma = malloc((ctx -> size > 0 ? ctx -> size : 1) * sizeof(uint64_t));
+        ctx -> cursors = malloc((ctx -> size > 0 ? ctx -> size : 1) * sizeof(size_t));
+        if (ctx -> sigma == NULL || ctx -> cursors == NULL) xtermina(LINEFILE, "Allocazione degli array per il conteggio dei cammini fallita");
+    }
+
+    // Ogni arco di incontro dà almeno un cammino, i primi maxPaths archi bastano per i primi maxPaths cammini
+    if (ctx -> meetingsCapacity < maxPaths) {
+        free(ctx -> meetings);
+        ctx -> meetings = malloc(2 * maxPaths * sizeof(int));
+        if (ctx -> meetings == NULL) xtermina(LINEFILE, "Allocazione degli archi di incontro fallita");
+        ctx -> meetingsCapacity = maxPaths;
+    }
+
+    e -> numCammini = 0;
+    e -> saturo = false;
+    e -> numIncontri = 0;
+    e -> iniziato = false;
+
+    bfsNewSearch(ctx);
+
+    uint32_t forward = ctx -> epoch;
+    uint32_t backward = ctx -> epoch + 1;
+
+    ctx -> visited[start] = forward;
+    ctx -> depth[start] = 0;
+    ctx -> sigma[start] = 1;
+    enqueue(ctx -> queue, start);
+
+    ctx -> visited[target] = backward;
+    ctx -> depth[target] = 0;
+    ctx -> sigma[target] = 1;
+    enqueue(ctx -> queueBackward, target);
+
+    int forwardLevel = 0, backwardLevel = 0;
+
+    while (!queueIsEmpty(ctx -> queue) && !queueIsEmpty(ctx -> queueBackward)) {
+        bool met;
+
+        if (ctx -> queue -> size <= ctx -> queueBackward -> size) {
+            met = expandCountingLevel(g, ctx, ctx -> queue, forward, backward, true, filter, maxPaths, e);
+            if (!met) forwardLevel++;
+        } else {
+            met = expandCountingLevel(g, ctx, ctx -> queueBackward, backward, forward, false, filter, maxPaths, e);
+            if (!met) backwardLevel++;
+        }
+
+        if (met) {
+            e -> distanza = forwardLevel + backwardLevel + 1;
+            e -> livelloAvanti = forwardLevel;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Riporta l'enumerazione al primo cammino, per scrivere di nuovo gli stessi cammini.
+ * @param e Enumeratore preparato da bfsCountPaths() e non usato da altre ricerche nel frattempo.
+ */
+void bfsRewindPaths(pathEnumerator* e) {
+    e -> iniziato = false;
+}
+
+/**
+ * @brief Posizione nel cammino del k-esimo nodo scelto dall'enumerazione.
+ * @details Le posizioni livelloAvanti e livelloAvanti + 1 sono fissate dall'arco di incontro, poi vengono scelti
+ *          prima i nodi del lato di start andando verso start e poi quelli del lato di target andando verso target.
+ * @param e Enumeratore.
+ * @param k Indice della scelta, da 0 a distanza - 2.
+ * @return Posizione nel cammino.
+ */
+static size_t enumeratedPosition(const pathEnumerator* e, size_t k) {
+    size_t lf = e -> livelloAvanti;
+    return k < lf ? lf - 1 - k : k + 2;
+}
+
+/**
+ * @brief Nodo già scelto a cui deve essere adiacente il nodo in una posizione del cammino.
+ * @param ctx Contesto con il cammino in costruzione.
+ * @param e Enumeratore.
+ * @param position Posizione nel cammino, diversa da quelle dell'arco di incontro.
+ * @return Id denso del nodo successivo (lato di start) o precedente (lato di target) nel cammino.
+ */
+static int anchorNode(const bfsContext* ctx, const pathEnumerator* e, size_t position) {
+    return position < (size_t) e -> livelloAvanti ? ctx -> path[position + 1] : ctx -> path[position - 1];
+}
+
+/**
+ * @brief Estrae in ctx -> path il prossimo cammino minimo, senza liste di predecessori.
+ * @details Per ogni arco di incontro (u, w) i cammini sono il prodotto delle discese da u verso start e da w verso target:
+ *          un vicino è il predecessore nella discesa se appartiene allo stesso lato e ha distanza inferiore di uno, e ogni
+ *          discesa arriva sempre all'estremo del lato. Le discese vengono enumerate in profondità con un cursore per
+ *          posizione nella lista dei vicini, quindi ogni cammino costa al più la somma dei gradi dei suoi nodi e
+ *          tra una chiamata e l'altra viene conservato solo lo stato dei cursori.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto dell'ultima bfsCountPaths() andata a buon fine.
+ * @param e Enumeratore preparato da bfsCountPaths().
+ * @return Numero di nodi del cammino, 0 se i cammini memorizzati sono finiti.
+ */
+size_t bfsNextPath(grafo* g, bfsContext* ctx, pathEnumerator* e) {
+    if (e -> numIncontri == 0) return 0;
+
+    uint32_t forward = ctx -> epoch;
+    uint32_t backward = ctx -> epoch + 1;
+    size_t distance = e -> distanza;
+    size_t lf = e -> livelloAvanti;
+
+    /*
+        k è il numero di nodi già scelti oltre ai due estremi dell'arco di incontro, con due valori speciali:
+        -1 per iniziare l'arco di incontro corrente e -2 quando le sue discese sono esaurite.
+    */
+    long numFree = distance - 1;
+    long k;
+
+    if (!e -> iniziato) {
+        e -> iniziato = true;
+        e -> incontro = 0;
+        k = -1;
+    }
+    else {
+        k = numFree > 0 ? numFree - 1 : -2; // Riprende dall'ultima scelta del cammino precedente
+    }
+
+    while (true) {
+        if (k < 0) {
+            if (k == -2 && ++(e -> incontro) == e -> numIncontri) return 0;
+
+            ctx -> path[lf] = ctx -> meetings[2 * e -> incontro];
+            ctx -> path[lf + 1] = ctx -> meetings[2 * e -> incontro + 1];
+            k = 0;
+
+            if (numFree > 0) ctx -> cursors[enumeratedPosition(e, 0)] = g -> offsets[anchorNode(ctx, e, enumeratedPosition(e, 0))];
+        }
+
+        if (k == numFree) return distance + 1;
+
+        size_t position = enumeratedPosition(e, k);
+        int anchor = anchorNode(ctx, e, position);
+
+        // Lato e distanza richiesti al nodo in questa posizione
+        uint32_t side = position < lf ? forward : backward;
+        int depth = position < lf ? (int) position : (int)(distance - position);
+
+        size_t i = ctx -> cursors[position];
+        while (i < g -> offsets[anchor + 1] && !(ctx -> visited[g -> vicini[i]] == side && ctx -> depth[g -> vicini[i]] == depth)) i++;
+
+        if (i < g -> offsets[anchor + 1]) {
+            ctx -> path[position] = g -> vicini[i];
+            ctx -> cursors[position] = i + 1;
+            k++;
+
+            if (k < numFree) ctx -> cursors[enumeratedPosition(e, k)] = g -> offsets[anchorNode(ctx, e, enumeratedPosition(e, k))];
+        }
+        else {
+            k = k == 0 ? -2 : k - 1;
+        }
+    }
+}
@@ -1,66 +1,150 @@
-#define _GNU_SOURCE
-
-#include "../CHeaders/actors.h"
-#include "../CHeaders/utilities.h"
-#include "../CHeaders/graph.h"
-#include "../CHeaders/signalHandler.h"
-#include "../CHeaders/shortestPaths.h"
-#include "../CHeaders/xerrori.h"
-
-#include <stdlib.h>
-#include <stdio.h>
-#include <signal.h>
-#include <errno.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-
-#define LINEFILE __LINE__,__FILE__
-
-/**
- * @file cammini.c
- * @brief Legge i dati del grafo degli autori ed effettua il calcolo di cammini minimi. 
- */
-
-int main(int argc, char* argv[]) {
-    // Convalida gli argomenti passati da linea di comando
-    if (!validateArguments(argc, argv)) {
-        printf("Errore: Utilizzo del programma invalido.\nUso: %s pathTo(nomi.txt) pathTo(grafo.txt) numConsumatori", argv[0]);
-        exit(2);
-    }
-
-    // Blocca SIGINT
-    sigset_t mask;
-    if (sigemptyset(&mask) != 0) xtermina(LINEFILE, "sigemptyset() nel main fallita");
-    if (sigaddset(&mask, SIGINT) != 0) xtermina(LINEFILE, "sigaddset() nel main fallita");
-    if (pthread_sigmask(SIG_BLOCK, &mask, NULL) != 0) xtermina(LINEFILE, "pthread_sigmask() fallita nel main");
-
-    // Crea thread gestore dei segnali (RUNNATO COME DETACHED)
-    volatile bool finishedGraph = false; // false fino a che non elabora tutto il grafo
-    volatile bool mustShutdown = false; // false fino a che non arriva SIGINT dopo il completamento dell'elaborazione del grafo
-    signalHandlerThreadInit(&finishedGraph, &mustShutdown);
-
-    // Lettura di nomi.txt e creazione dell'array dei nodi attore
-    size_t attoriSize;
-    attore** attori = createActors(argv[1], &attoriSize);
-
-    // Lettura di grafo.txt e riempimento dei campi numcop e cop degli attori
-    processGraph(argv[2], atoi(argv[3]), attori, attoriSize);
-
-    // NOTA: Non mi serve un mutex dato che l'unica scrittura è questa, oltretutto atomica su architetture moderne
-    finishedGraph = true; // Comunica al thread gestore dei segnali che ha finito
-        
-    // Crea la named pipe di comunicazione
-    int e = mkfifo("cammini.pipe", 0660);
-    if (e == 0) fprintf(stderr, "Named pipe creata.\n");
-    else if (errno == EEXIST) fprintf(stderr, "Pipe già esistente.\n");
-    else xtermina(LINEFILE, "Creazione della named pipe fallita");
-
-    pipeReader(attoriSize, attori, &mustShutdown);
-
-    // Elimina la named pipe creata
-    if (unlink("cammini.pipe") == -1) xtermina(LINEFILE, "Errore nella distruzione della named pipe");
-
-    freeAttori(attori, attoriSize);
-
-    return 0;
+#define _GNU_SOURCE
+
+#include "../CHeaders/actors.h"
+#include "../CHeaders/utilities.h"
+#include "../CHeaders/graph.h"
+#include "../CHeaders/signalHandler.h"
+#include "../CHeaders/shortestPaths.h"
+#include "../CHeaders/threadPool.h"
+#include "../CHeaders/snapshot.h"
+#include "../CHeaders/batch.h"
+#include "../CHeaders/landmarks.h"
+#include "../CHeaders/components.h"
+#include "../CHeaders/responses.h"
+#include "../CHeaders/analysis.h"
+#include "../CHeaders/centrality.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <signal.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+
+#define LINEFILE __LINE__,__FILE__
+
+/**
+ * @file cammini.c
+ * @brief Legge i dati del grafo degli autori ed effettua il calcolo di cammini minimi. 
+ */
+
+/**
+ * @brief Crea una named pipe, se non esiste già.
+ * @param path Percorso della named pipe.
+ */
+static void createFifo(const char* path) {
+    int e = mkfifo(path, 0660);
+    if (e == 0) fprintf(stderr, "Named pipe %s creata.\n", path);
+    else if (errno == EEXIST) fprintf(stderr, "Pipe %s già esistente.\n", path);
+    else xtermina(LINEFILE, "Creazione della named pipe %s fallita", path);
+}
+
+int main(int argc, char* argv[]) {
+    // Convalida gli argomenti passati da linea di comando
+    opzioni opts;
+    if (!validateArguments(argc, argv, &opts)) {
+        printUsage(argv[0]);
+        exit(2);
+    }
+
+    // Blocca SIGINT
+    sigset_t mask;
+    if (sigemptyset(&mask) != 0) xtermina(LINEFILE, "sigemptyset() nel main fallita");
+    if (sigaddset(&mask, SIGINT) != 0) xtermina(LINEFILE, "sigaddset() nel main fallita");
+    if (pthread_sigmask(SIG_BLOCK, &mask, NULL) != 0) xtermina(LINEFILE, "pthread_sigmask() fallita nel main");
+
+    // Crea thread gestore dei segnali (RUNNATO COME DETACHED)
+    volatile bool finishedGraph = false; // false fino a che non elabora tutto il grafo
+    volatile bool mustShutdown = false; // false fino a che non arriva SIGINT dopo il completamento dell'elaborazione del grafo
+
+    // Segnalato insieme a mustShutdown, sveglia il server delle pipe in attesa su epoll
+    int shutdownFd = eventfd(0, EFD_CLOEXEC);
+    if (shutdownFd == -1) xtermina(LINEFILE, "Creazione dell'eventfd di terminazione fallita");
+
+    signalHandlerThreadInit(&finishedGraph, &mustShutdown, shutdownFd);
+
+    grafo* g = NULL;
+
+    // Se disponibile mappa lo snapshot binario, senza parsing
+    if (opts.snapshot != NULL && snapshotIsUsable(opts.snapshot, opts.fileNomi, opts.fileGrafo)) g = loadSnapshot(opts.snapshot);
+
+    if (g == NULL) {
+        if (opts.fileNomi == NULL) xtermina(LINEFILE, "Snapshot %s non disponibile e file di testo non specificati", opts.snapshot);
+
+        // Lettura di nomi.txt e grafo.txt in parallelo e costruzione del grafo in formato CSR
+        g = processGraph(opts.fileNomi, opts.fileGrafo, opts.numConsumatori);
+
+        // Salva lo snapshot per gli avvii successivi
+        if (opts.snapshot != NULL) saveSnapshot(g, opts.snapshot);
+    }
+
+    // Componenti connesse, le richieste tra componenti diverse vengono risposte senza ricerca
+    componentIndex* componenti = componentsBuild(g, opts.numThread);
+
+    // Indice delle distanze dai landmark, caricato o calcolato dopo il grafo
+    landmarkIndex* landmarks = landmarkPrepare(g, opts.numLandmark, opts.fileNomi, opts.fileGrafo, opts.snapshot);
+
+    // NOTA: Non mi serve un mutex dato che l'unica scrittura è questa, oltretutto atomica su architetture moderne
+    finishedGraph = true; // Comunica al thread gestore dei segnali che ha finito
+
+    // Modalità analisi e centralità: statistiche dell'intero grafo, poi termina senza named pipe né file a.b
+    if (opts.analisi || opts.centralita) {
+        if (opts.analisi) runAnalysis(g, &opts, &mustShutdown);
+        if (opts.centralita && !mustShutdown) runCentrality(g, &opts, &mustShutdown);
+        landmarkFree(landmarks);
+        componentsFree(componenti);
+        freeGrafo(g);
+        return 0;
+    }
+
+    // Pipe delle risposte, senza un lettore connesso le risposte vengono comunque scritte nei file a.b
+    responseChannel* risposte = NULL;
+
+    if (opts.fileRisposte != NULL) {
+        // Un lettore che chiude la pipe delle risposte viene gestito con EPIPE
+        if (signal(SIGPIPE, SIG_IGN) == SIG_ERR) xtermina(LINEFILE, "Impossibile ignorare SIGPIPE");
+
+        createFifo(opts.fileRisposte);
+        risposte = responseChannelCreate(opts.fileRisposte, opts.formatoRisposte);
+    }
+
+    // Modalità batch: risponde alle coppie del file e termina senza creare le named pipe delle richieste
+    if (opts.fileBatch != NULL) {
+        runBatch(g, componenti, risposte, &opts, &mustShutdown);
+        responseChannelFree(risposte);
+        if (opts.fileRisposte != NULL) unlink(opts.fileRisposte);
+        landmarkFree(landmarks);
+        componentsFree(componenti);
+        freeGrafo(g);
+        return 0;
+    }
+        
+    // Crea le named pipe di comunicazione
+    for (size_t i = 0; i < opts.numPipe; i++) createFifo(opts.pipes[i]);
+
+    // Pool di thread calcolatori di cammini minimi
+    threadPool* pool = poolCreate(g, landmarks, componenti, risposte, &opts);
+
+    pipeReader(pool, &opts, shutdownFd);
+
+    // Completa le richieste ancora in coda e attende i worker
+    poolDestroy(pool);
+
+    // Elimina le named pipe create
+    for (size_t i = 0; i < opts.numPipe; i++) {
+        if (unlink(opts.pipes[i]) == -1) xtermina(LINEFILE, "Errore nella distruzione della named pipe %s", opts.pipes[i]);
+    }
+
+    if (opts.fileRisposte != NULL) {
+        responseChannelFree(risposte);
+        if (unlink(opts.fileRisposte) == -1) xtermina(LINEFILE, "Errore nella distruzione della named pipe %s", opts.fileRisposte);
+    }
+
+    landmarkFree(landmarks);
+    componentsFree(componenti);
+    freeGrafo(g);
+
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,301 @@
+#define _GNU_SOURCE
+
+#include "../CHeaders/centrality.h"
+#include "../CHeaders/analysis.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/times.h>
+
+static const double* sortBetweenness; // Betweenness usata da compareByCentrality()
+static const double* sortCloseness; // Closeness usata da compareByCentrality()
+
+/**
+ * @brief Compara due nodi per betweenness decrescente e, a parità, per closeness decrescente, per l'ordinamento con qsort().
+ * @param x Puntatore al primo id denso.
+ * @param y Puntatore al secondo id denso.
+ * @return Negativo se il primo nodo è più centrale.
+ */
+static int compareByCentrality(const void* x, const void* y) {
+    int u = *(const int*) x, v = *(const int*) y;
+
+    if (sortBetweenness[u] != sortBetweenness[v]) return sortBetweenness[u] < sortBetweenness[v] ? 1 : -1;
+    if (sortCloseness[u] != sortCloseness[v]) return sortCloseness[u] < sortCloseness[v] ? 1 : -1;
+    return (u > v) - (u < v);
+}
+
+/**
+ * @brief Visita di Brandes da una sorgente: conta i cammini minimi e accumula le dipendenze nei buffer del worker.
+ * @details La BFS calcola distanze e numero di cammini minimi sigma; poi i nodi vengono ripresi in ordine inverso
+ *          di visita e ognuno propaga la propria dipendenza ai vicini a distanza inferiore di uno, che sono i suoi
+ *          predecessori: non serve memorizzare le liste dei predecessori, basta l'array delle distanze.
+ *          Alla fine vengono azzerati solo i nodi visitati.
+ * @param g Grafo degli attori.
+ * @param w Buffer del worker chiamante.
+ * @param s Id denso della sorgente.
+ */
+static void brandes(grafo* g, centralityWorker* w, int s) {
+    int* distanze = w -> distanze;
+    double* sigma = w -> sigma;
+    double* delta = w -> delta;
+    int* ordine = w -> ordine;
+
+    size_t head = 0, tail = 0;
+
+    ordine[tail++] = s;
+    distanze[s] = 0;
+    sigma[s] = 1;
+
+    while (head < tail) {
+        int v = ordine[head++];
+
+        w -> archiEsaminati += g -> offsets[v + 1] - g -> offsets[v];
+
+        for (size_t i = g -> offsets[v]; i < g -> offsets[v + 1]; i++) {
+            int u = g -> vicini[i];
+
+            if (distanze[u] < 0) {
+                distanze[u] = distanze[v] + 1;
+                ordine[tail++] = u;
+            }
+
+            if (distanze[u] == distanze[v] + 1) sigma[u] += sigma[v];
+        }
+    }
+
+    // Il grafo non è orientato: la distanza da s a v è anche quella da v a s
+    for (size_t i = 1; i < tail; i++) {
+        w -> sommaDistanze[ordine[i]] += distanze[ordine[i]];
+        w -> raggiunto[ordine[i]]++;
+    }
+
+    for (size_t i = tail - 1; i > 0; i--) {
+        int u = ordine[i];
+        double coefficient = (1 + delta[u]) / sigma[u];
+
+        for (size_t j = g -> offsets[u]; j < g -> offsets[u + 1]; j++) {
+            int v = g -> vicini[j];
+            if (distanze[v] == distanze[u] - 1) delta[v] += sigma[v] * coefficient;
+        }
+
+        w -> betweenness[u] += delta[u];
+    }
+
+    for (size_t i = 0; i < tail; i++) {
+        distanze[ordine[i]] = -1;
+        sigma[ordine[i]] = 0;
+        delta[ordine[i]] = 0;
+    }
+}
+
+/**
+ * @brief Funzione eseguita dai worker della centralità: prelevano CENTRALITY_LOT sorgenti alla volta finché non sono finite.
+ * @details Ogni worker accumula betweenness e distanze nei propri array, sommati a quelli condivisi sotto mutex
+ *          solo dopo l'ultima sorgente, così le visite non si contendono mai gli stessi accumulatori.
+ * @param arg Puntatore allo stato condiviso del calcolo.
+ */
+void* centralityWorkerBody(void* arg) {
+    centralityState* state = (centralityState*) arg;
+    grafo* g = state -> g;
+    size_t n = g -> numNodi;
+
+    // Buffer del worker, allocati una sola volta per tutte le sorgenti
+    centralityWorker w;
+    w.distanze = malloc(n * sizeof(int));
+    w.sigma = calloc(n, sizeof(double));
+    w.delta = calloc(n, sizeof(double));
+    w.ordine = malloc(n * sizeof(int));
+    w.betweenness = calloc(n, sizeof(double));
+    w.sommaDistanze = calloc(n, sizeof(uint64_t));
+    w.raggiunto = calloc(n, sizeof(uint32_t));
+    w.archiEsaminati = 0;
+    if (w.distanze == NULL || w.sigma == NULL || w.delta == NULL || w.ordine == NULL || w.betweenness == NULL || w.sommaDistanze == NULL || w.raggiunto == NULL) {
+        xtermina(LINEFILE, "Allocazione dei buffer del worker della centralità fallita");
+    }
+
+    for (size_t v = 0; v < n; v++) w.distanze[v] = -1;
+
+    while (true) {
+        // Zona critica
+        xpthread_mutex_lock(&state -> mutex, LINEFILE);
+
+        size_t first = state -> prossimaSorgente;
+        size_t count = *(state -> mustShutdown) ? 0 : state -> numSorgenti - first;
+        if (count > CENTRALITY_LOT) count = CENTRALITY_LOT;
+        state -> prossimaSorgente += count;
+
+        xpthread_mutex_unlock(&state -> mutex, LINEFILE);
+        // Fine zona critica
+
+        if (count == 0) break;
+
+        uint64_t edgesBefore = w.archiEsaminati;
+        for (size_t i = first; i < first + count; i++) brandes(g, &w, state -> sorgenti[i]);
+
+        // Zona critica
+        xpthread_mutex_lock(&state -> mutex, LINEFILE);
+
+        state -> sorgentiCompletate += count;
+        state -> archiEsaminati += w.archiEsaminati - edgesBefore;
+
+        double elapsed = (double)(times(NULL) - state -> inizio) / sysconf(_SC_CLK_TCK);
+
+        if ((double)(times(NULL) - state -> ultimaStampa) / sysconf(_SC_CLK_TCK) >= CENTRALITY_PROGRESS_SECONDS) {
+            double rate = elapsed > 0 ? state -> sorgentiCompletate / elapsed : 0;
+
+            fprintf(stderr, "Centralità: %zu/%zu sorgenti (%.1f%%), %.0f sorgenti/s, fine stimata tra %.0f secondi.\n",
+                    state -> sorgentiCompletate, state -> numSorgenti, 100.0 * state -> sorgentiCompletate / state -> numSorgenti, rate,
+                    rate > 0 ? (state -> numSorgenti - state -> sorgentiCompletate) / rate : 0.0);
+
+            state -> ultimaStampa = times(NULL);
+        }
+
+        xpthread_mutex_unlock(&state -> mutex, LINEFILE);
+        // Fine zona critica
+    }
+
+    // Unisce gli accumulatori locali a quelli condivisi
+    xpthread_mutex_lock(&state -> mutex, LINEFILE);
+
+    for (size_t v = 0; v < n; v++) {
+        state -> betweenness[v] += w.betweenness[v];
+        state -> sommaDistanze[v] += w.sommaDistanze[v];
+        state -> raggiunto[v] += w.raggiunto[v];
+    }
+
+    xpthread_mutex_unlock(&state -> mutex, LINEFILE);
+
+    free(w.distanze);
+    free(w.sigma);
+    free(w.delta);
+    free(w.ordine);
+    free(w.betweenness);
+    free(w.sommaDistanze);
+    free(w.raggiunto);
+
+    pthread_exit(NULL);
+}
+
+/**
+ * @brief Calcola i valori finali di centralità e scrive la classifica degli attori.
+ * @details La betweenness accumulata conta ogni coppia non ordinata due volte, una per verso, e viene quindi dimezzata;
+ *          con il campionamento viene scalata di numNodi / sorgenti visitate. La closeness è quella di Wasserman e Faust,
+ *          adatta a grafi non connessi: frazione di nodi raggiunti divisa per la distanza media da essi. Con il campionamento
+ *          entrambe sono stimate sulle sole sorgenti visitate.
+ * @param state Stato del calcolo terminato.
+ * @param numSorgenti Sorgenti effettivamente visitate.
+ */
+static void writeRanking(centralityState* state, size_t numSorgenti) {
+    grafo* g = state -> g;
+    size_t n = g -> numNodi;
+
+    double* closeness = malloc(n * sizeof(double));
+    int* order = malloc(n * sizeof(int));
+    if (closeness == NULL || order == NULL) xtermina(LINEFILE, "Allocazione della classifica di centralità fallita");
+
+    double scale = numSorgenti > 0 ? (double) n / numSorgenti / 2 : 0;
+
+    for (size_t v = 0; v < n; v++) {
+        state -> betweenness[v] *= scale;
+
+        // Sorgenti diverse da v: nel calcolo esatto tutti gli altri nodi
+        size_t others = numSorgenti - (state -> sorgente[v] ? 1 : 0);
+        uint32_t reached = state -> raggiunto[v];
+
+        closeness[v] = reached > 0 ? ((double) reached / others) * ((double) reached / state -> sommaDistanze[v]) : 0;
+        order[v] = v;
+    }
+
+    sortBetweenness = state -> betweenness;
+    sortCloseness = closeness;
+    qsort(order, n, sizeof(int), compareByCentrality);
+
+    FILE* file = xfopen(CENTRALITY_FILE, "w", LINEFILE);
+    fprintf(file, "posizione\tcodice\tnome\tgrado\tbetweenness\tcloseness\n");
+
+    for (size_t i = 0; i < n; i++) {
+        int v = order[i];
+        fprintf(file, "%zu\t%d\t%s\t%zu\t%.6f\t%.6f\n", i + 1, g -> codici[v], nodeName(g, v), g -> offsets[v + 1] - g -> offsets[v], state -> betweenness[v], closeness[v]);
+    }
+
+    fclose(file);
+
+    fprintf(stderr, "Classifica di centralità scritta in %s, i primi %d attori per betweenness:\n", CENTRALITY_FILE, CENTRALITY_TOP);
+
+    for (size_t i = 0; i < n && i < CENTRALITY_TOP; i++) {
+        int v = order[i];
+        fprintf(stderr, "  %zu. %d %s: betweenness %.1f, closeness %.4f\n", i + 1, g -> codici[v], nodeName(g, v), state -> betweenness[v], closeness[v]);
+    }
+
+    free(closeness);
+    free(order);
+}
+
+/**
+ * @brief Modalità centralità: betweenness e closeness di ogni attore con l'algoritmo di Brandes.
+ * @details Le sorgenti (tutti i nodi, o un campione uniforme di opts -> numCampioni nodi per un risultato approssimato)
+ *          vengono distribuite tra opts -> numThread worker, ognuno con accumulatori propri uniti alla fine.
+ *          All'arrivo di SIGINT le sorgenti non ancora iniziate vengono saltate e la classifica viene scritta,
+ *          come stima campionata, su quelle completate.
+ * @param g Grafo degli attori.
+ * @param opts Opzioni passate da linea di comando.
+ * @param mustShutdown Booleano per gestire l'arrivo di SIGINT.
+ */
+void runCentrality(grafo* g, const opzioni* opts, volatile bool* mustShutdown) {
+    size_t n = g -> numNodi;
+    if (n == 0) return;
+
+    centralityState state;
+    state.g = g;
+    state.sorgenti = chooseSources(n, opts -> numCampioni, &state.numSorgenti);
+    state.sorgente = calloc(n, sizeof(bool));
+    state.prossimaSorgente = 0;
+    state.sorgentiCompletate = 0;
+    state.betweenness = calloc(n, sizeof(double));
+    state.sommaDistanze = calloc(n, sizeof(uint64_t));
+    state.raggiunto = calloc(n, sizeof(uint32_t));
+    state.archiEsaminati = 0;
+    state.inizio = times(NULL);
+    state.ultimaStampa = state.inizio;
+    state.mustShutdown = mustShutdown;
+    if (state.sorgente == NULL || state.betweenness == NULL || state.sommaDistanze == NULL || state.raggiunto == NULL) {
+        xtermina(LINEFILE, "Allocazione dei risultati della centralità fallita");
+    }
+    xpthread_mutex_init(&state.mutex, NULL, LINEFILE);
+
+    for (size_t i = 0; i < state.numSorgenti; i++) state.sorgente[state.sorgenti[i]] = true;
+
+    size_t numWorkers = opts -> numThread < state.numSorgenti ? opts -> numThread : state.numSorgenti;
+
+    fprintf(stderr, "Inizio calcolo della centralità %s: %zu sorgenti con %zu worker.\n",
+            state.numSorgenti == n ? "esatta" : "campionata", state.numSorgenti, numWorkers);
+
+    pthread_t workers[numWorkers];
+
+    for (size_t i = 0; i < numWorkers; i++) xpthread_create(&workers[i], NULL, &centralityWorkerBody, &state, LINEFILE);
+    for (size_t i = 0; i < numWorkers; i++) xpthread_join(workers[i], NULL, LINEFILE);
+
+    double elapsed = (double)(times(NULL) - state.inizio) / sysconf(_SC_CLK_TCK);
+
+    if (state.sorgentiCompletate < state.numSorgenti) {
+        fprintf(stderr, "Calcolo interrotto: classifica stimata su %zu sorgenti su %zu.\n", state.sorgentiCompletate, state.numSorgenti);
+
+        // Le sorgenti completate sono le prime, le altre non vanno contate nella closeness
+        for (size_t i = state.sorgentiCompletate; i < state.numSorgenti; i++) state.sorgente[state.sorgenti[i]] = false;
+    }
+
+    fprintf(stderr, "Centralità calcolata in %.3f secondi (%.0f sorgenti/s, %.1f milioni di archi/s).\n", elapsed,
+            elapsed > 0 ? state.sorgentiCompletate / elapsed : 0.0, elapsed > 0 ? state.archiEsaminati / elapsed / 1e6 : 0.0);
+
+    writeRanking(&state, state.sorgentiCompletate);
+
+    xpthread_mutex_destroy(&state.mutex, LINEFILE);
+    free(state.sorgenti);
+    free(state.sorgente);
+    free(state.betweenness);
+    free(state.sommaDistanze);
+    free(state.raggiunto);
+}
@@ -0,0 +1,207 @@
+#define _GNU_SOURCE
+
+#include "../CHeaders/components.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/times.h>
+
+/**
+ * @brief Trova la radice dell'albero union-find di un nodo, dimezzando il percorso.
+ * @details Ogni nodo visitato viene fatto puntare al nonno con un compare-and-swap: se un altro thread
+ *          lo ha già modificato il tentativo fallisce senza conseguenze, il padre resta comunque un antenato.
+ * @param padri Foresta union-find.
+ * @param v Nodo di partenza.
+ * @return Radice dell'albero di v.
+ */
+static int findRoot(int* padri, int v) {
+    while (true) {
+        int p = __atomic_load_n(&padri[v], __ATOMIC_RELAXED);
+        if (p == v) return v;
+
+        int gp = __atomic_load_n(&padri[p], __ATOMIC_RELAXED);
+        if (p != gp) __atomic_compare_exchange_n(&padri[v], &p, gp, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+
+        v = gp;
+    }
+}
+
+/**
+ * @brief Unisce gli alberi union-find di due nodi.
+ * @details La radice con id maggiore viene appesa a quella con id minore, quindi non si possono formare cicli
+ *          e la radice di ogni componente è il suo nodo minimo. Se il compare-and-swap fallisce la radice è stata
+ *          appesa da un altro thread nel frattempo, si riparte cercando le nuove radici.
+ * @param padri Foresta union-find.
+ * @param u Primo nodo.
+ * @param v Secondo nodo.
+ */
+static void unite(int* padri, int u, int v) {
+    while (true) {
+        u = findRoot(padri, u);
+        v = findRoot(padri, v);
+        if (u == v) return;
+
+        if (u < v) {
+            int tmp = u;
+            u = v;
+            v = tmp;
+        }
+
+        int expected = u;
+        if (__atomic_compare_exchange_n(&padri[u], &expected, v, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) return;
+    }
+}
+
+/**
+ * @brief Funzione eseguita dai thread che uniscono gli estremi di tutti gli archi dei propri nodi.
+ * @param arg Puntatore ad una struct componentsWorkerData.
+ */
+static void* componentsWorkerBody(void* arg) {
+    componentsWorkerData* data = (componentsWorkerData*) arg;
+    grafo* g = data -> g;
+
+    for (size_t u = data -> start; u < data -> end; u++) {
+        for (size_t i = g -> offsets[u]; i < g -> offsets[u + 1]; i++) {
+            unite(data -> padri, u, g -> vicini[i]);
+        }
+    }
+
+    pthread_exit(NULL);
+}
+
+/**
+ * @brief Cerca il primo nodo i cui archi iniziano almeno da una certa posizione dell'array dei vicini.
+ * @param g Grafo degli attori.
+ * @param arco Posizione nell'array dei vicini.
+ * @return Primo nodo v con offsets[v] >= arco, numNodi se non esiste.
+ */
+static size_t nodeAtEdge(grafo* g, size_t arco) {
+    size_t low = 0, high = g -> numNodi;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (g -> offsets[mid] < arco) low = mid + 1;
+        else high = mid;
+    }
+
+    return low;
+}
+
+/**
+ * @brief Calcola le componenti connesse del grafo con una union-find parallela.
+ * @details I nodi sono divisi tra i thread in blocchi con lo stesso numero di archi, le unioni avvengono senza lock
+ *          con compare-and-swap. Alla fine le radici (nodi minimi delle componenti) vengono numerate in ordine e ogni
+ *          nodo riceve l'etichetta del padre, che ha id minore ed è quindi già etichettato. Infine stampa il resoconto.
+ * @param g Grafo degli attori.
+ * @param numThreads Numero di thread da usare.
+ * @return Puntatore all'indice delle componenti.
+ */
+componentIndex* componentsBuild(grafo* g, size_t numThreads) {
+    clock_t timeStart = times(NULL);
+
+    componentIndex* index = malloc(sizeof(componentIndex));
+    if (index == NULL) xtermina(LINEFILE, "Allocazione dell'indice delle componenti fallita");
+
+    size_t n = g -> numNodi;
+    index -> numNodi = n;
+    index -> etichette = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (index -> etichette == NULL) xtermina(LINEFILE, "Allocazione delle etichette delle componenti fallita");
+
+    // Le etichette fanno prima da foresta union-find, ogni nodo è inizialmente la radice di sé stesso
+    int* padri = index -> etichette;
+    for (size_t v = 0; v < n; v++) padri[v] = v;
+
+    if (numThreads < 1) numThreads = 1;
+
+    pthread_t threads[numThreads];
+    componentsWorkerData data[numThreads];
+
+    for (size_t i = 0; i < numThreads; i++) {
+        data[i].g = g;
+        data[i].padri = padri;
+        data[i].start = i == 0 ? 0 : data[i - 1].end;
+        data[i].end = i == numThreads - 1 ? n : nodeAtEdge(g, g -> numArchi / numThreads * (i + 1));
+        if (data[i].end < data[i].start) data[i].end = data[i].start;
+
+        xpthread_create(&threads[i], NULL, &componentsWorkerBody, &data[i], LINEFILE);
+    }
+
+    for (size_t i = 0; i < numThreads; i++) xpthread_join(threads[i], NULL, LINEFILE);
+
+    /*
+        Numerazione delle componenti: il padre di ogni nodo ha id minore del nodo, quindi scorrendo i nodi
+        in ordine il padre ha già ricevuto l'etichetta della componente e basta copiarla.
+    */
+    size_t count = 0;
+
+    for (size_t v = 0; v < n; v++) {
+        int p = padri[v];
+        padri[v] = p == (int) v ? (int) count++ : padri[p];
+    }
+
+    index -> numComponenti = count;
+    index -> dimensioni = calloc(count > 0 ? count : 1, sizeof(size_t));
+    if (index -> dimensioni == NULL) xtermina(LINEFILE, "Allocazione delle dimensioni delle componenti fallita");
+
+    for (size_t v = 0; v < n; v++) index -> dimensioni[index -> etichette[v]]++;
+
+    componentsReport(index, (double)(times(NULL) - timeStart) / sysconf(_SC_CLK_TCK));
+
+    return index;
+}
+
+/**
+ * @brief Controlla in O(1) se due nodi appartengono alla stessa componente connessa.
+ * @param index Indice delle componenti (NULL se non calcolato).
+ * @param idA Id denso del primo nodo.
+ * @param idB Id denso del secondo nodo.
+ * @return false solo se il cammino tra i due nodi sicuramente non esiste.
+ */
+bool componentsConnected(const componentIndex* index, int idA, int idB) {
+    if (!index) return true;
+
+    return index -> etichette[idA] == index -> etichette[idB];
+}
+
+/**
+ * @brief Stampa su stderr numero e dimensioni delle componenti connesse.
+ * @param index Indice delle componenti.
+ * @param seconds Tempo di calcolo dell'indice.
+ */
+void componentsReport(const componentIndex* index, double seconds) {
+    size_t istogramma[COMPONENTS_HISTOGRAM] = {0};
+    size_t massima = 0, isolati = 0;
+
+    for (size_t c = 0; c < index -> numComponenti; c++) {
+        size_t size = index -> dimensioni[c];
+
+        if (size > massima) massima = size;
+        if (size == 1) isolati++;
+
+        // Classe i: dimensioni da 2^i a 2^(i+1) - 1
+        int classe = 0;
+        while (classe < COMPONENTS_HISTOGRAM - 1 && (size >> (classe + 1)) > 0) classe++;
+        istogramma[classe]++;
+    }
+
+    fprintf(stderr, "%zu componenti connesse calcolate in %.3f secondi: la più grande ha %zu nodi (%.1f%%), %zu nodi isolati.\n",
+            index -> numComponenti, seconds, massima, index -> numNodi > 0 ? 100.0 * massima / index -> numNodi : 0.0, isolati);
+
+    for (int i = 0; i < COMPONENTS_HISTOGRAM; i++) {
+        if (istogramma[i] > 0) fprintf(stderr, "  componenti da %zu a %zu nodi: %zu\n", (size_t) 1 << i, ((size_t) 1 << (i + 1)) - 1, istogramma[i]);
+    }
+}
+
+/**
+ * @brief Dealloca l'indice delle componenti.
+ * @param index Puntatore all'indice.
+ */
+void componentsFree(componentIndex* index) {
+    if (!index) return;
+
+    free(index -> etichette);
+    free(index -> dimensioni);
+    free(index);
+}
@@ -1,201 +1,378 @@
-#define _GNU_SOURCE
-
-#include "../CHeaders/graph.h"
-#include "../CHeaders/utilities.h"
-#include "../CHeaders/actors.h"
-#include "../CHeaders/xerrori.h"
-
-
-#include <string.h>
-#include <sys/types.h>
-#include <unistd.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <pthread.h>
-
-#define BUFFER_SIZE 20
-
-/**
- * @brief Esegue il parsing di una linea nel buffer e aggiorna il nodo dell'attore
- * @param line Linea da parsare in formato: actorCode\t#coprotagonisti\tcoprot1Code\tcoprot2Code\t...\tcoprotNCode\t\n
- * @param arr Array dei nodi attore creato in createActors().
- * @param n Size dell'array arr
- */
-void updateCoprotagonists(char* line, attore** arr, size_t n) {
-    char* token;
-    char* savePtr; // Usato per strtok_r
-    int index = 0;
-
-    // Parsa il codice
-    token = strtok_r(line, "\t", &savePtr);
-    if (token == NULL) {
-        freeAttori(arr, n);
-        xtermina(LINEFILE, "strtok fallita nel thread consumatore: %ld", (long) gettid());
-    }
-    int code = atoi(token);
-
-    // Ricerca binaria del nodo corretto
-    attore* actor = *(attore**) bsearch(&code, arr, n, sizeof(attore*), &compareAttore);
-
-    actor -> codice = code;
-
-    // Parsa il numero di coprotagonisti
-    token = strtok_r(NULL, "\t", &savePtr);
-    if (token == NULL) {
-        freeAttori(arr, n);
-        xtermina(LINEFILE, "strtok fallita nel thread consumatore: %ld", (long) gettid());
-    }
-    actor -> numcop = atoi(token);
-
-    // Alloca array dei coprotagonisti e aggiungilo al nodo
-    int* temp = malloc((actor -> numcop) * sizeof(int));
-    if (temp == NULL) xtermina(LINEFILE, "Allocazione dell'array dei coprotagonisti fallita nel thread consumatore: %ld", (long) gettid());
-    actor -> cop = temp;
-
-    // Parsa i codici dei coprotagonisti
-    while ((token = strtok_r(NULL, "\t", &savePtr)) != NULL && index < actor -> numcop) {
-        (actor -> cop)[index++] = atoi(token); 
-    }
-
-    // Check correttezza del file grafo.txt
-    if (index != actor -> numcop) {
-        freeAttori(arr, n);
-        xtermina(LINEFILE, "Mismatch nel numero dei coprotagonisti dato e quello effettivo dell'attore: %d\n\tTrovati: %d\n\tPrevisti: %d", code, index, actor -> numcop);
-    }
-}
-
-
-/**
- * @brief Funzione eseguita dai thread consumatori.
- * @arg Struct con i dati passata dal thread creatore.
- */
-void* workerBody(void* arg) {
-    workerData* data = (workerData*) arg;
-
-    char* current; // Linea attuale
-
-    do {
-        // Zona critica
-        xsem_wait(data -> itemsIn, LINEFILE);
-        xpthread_mutex_lock(data -> mutex, LINEFILE);
-
-        current = data -> buffer[*(data -> index) % BUFFER_SIZE];
-        *(data -> index) += 1;
-
-        xpthread_mutex_unlock(data -> mutex, LINEFILE);
-        xsem_post(data -> freeSlots, LINEFILE);
-        // Fine zona critica
-
-        if (!current) continue;
-
-        // Update dei coprotagonisti dell'attore
-        updateCoprotagonists(current, data -> attori, data -> attoriSize);
-
-        free(current); // Le linee erano state duplicate dal produttore (copy)
-    } while (current != NULL);
-
-    pthread_exit(NULL);
-}
-
-
-/**
- * @brief Funzione eseguita dal thread produttore.
- * @param filePath Percorso del file grafo.txt
- * @param buffer Buffero produttore/consumatori.
- * @param freeSlots Semaforo degli elementi liberi.
- * @param itemsIn Semaforo degli elementi occupati.
- * @param n Numero dei threads consumatori.
- */
-void producerBody(FILE* file, char** buffer, sem_t* freeSlots, sem_t* itemsIn, size_t n) {
-    char* line = NULL; // Buffer per la linea
-    size_t len = 0; // Dimensione iniziale del buffer
-    ssize_t read; // Numero di caratteri letti (-1 per fine del file o errore)
-
-    int index = 0;
-
-    // Ciclo di lettura dal file grafo.txt
-    while ((read = getline(&line, &len, file)) != -1) {
-        if (read <= 1 || line[0] == '\n') continue; // Salta ultima linea o linee vuote
-
-        char* copy = strdup(line);
-        if (copy == NULL) xtermina(LINEFILE, "strdup fallita nel thread produttore");
-
-        // Aggiunge la riga letta al buffer
-        xsem_wait(freeSlots, LINEFILE);
-        buffer[index++ % BUFFER_SIZE] = copy;
-        xsem_post(itemsIn, LINEFILE);
-    }
-
-    // Check se c'è stato un errore durante la lettura dal file
-    if (ferror(file)) xtermina(LINEFILE, "Lettura dal file grafo.txt fallita");
-
-    free(line); // copy verrà deallocata dai thread consumatori
-
-    // Aggiunge segnale di termine ai thread consumatori
-    for (size_t i = 0; i < n; i++) {
-        xsem_wait(freeSlots, LINEFILE);
-        buffer[index++ % BUFFER_SIZE] = NULL;
-        xsem_post(itemsIn, LINEFILE);
-    }
-}
-
-
-/**
- * @brief Processa il file grafo.txt riempiendo i campi cop e numcop dei nodi attore utilizzando uno schema produttore/consumatori
- * @param filePath Percorso del file grafo.txt
- * @param n Argomento numconsumatori passato da linea di comando e convertito ad intero.
- * @param attori Array dei nodi attore creato in createActors().
- */
-void processGraph(char* filePath, size_t n, attore** attori, size_t attoriSize) {
-    FILE* file = xfopen(filePath, "r", LINEFILE);
-
-    // Crea il buffer
-    char** buffer = malloc(BUFFER_SIZE * sizeof(char*));
-    if (buffer == NULL) handleWithFileError("Allocazione del buffer produttore/consumatori fallita", file);
-
-    // Crea i thread
-    pthread_t* threads = malloc(n * sizeof(pthread_t));
-    workerData* threadData = malloc(n * sizeof(workerData));
-    if (threads == NULL || threadData == NULL) handleWithFileError("Allocazione degli array dei threads fallita", file);
-
-    sem_t freeSlots, itemsIn;
-    xsem_init(&freeSlots, 0, BUFFER_SIZE, LINEFILE);
-    xsem_init(&itemsIn, 0, 0, LINEFILE);
-
-    pthread_mutex_t mutex;
-    xpthread_mutex_init(&mutex, NULL, LINEFILE);
-
-    int cindex = 0;
-
-    int error; // Variabile di check per errore
-
-    // Crea i thread consumatori
-    for (size_t i = 0; i < n; i++) {
-        // Riempio i dati da passare al thread
-        threadData[i].buffer = buffer;
-        threadData[i].index = &cindex;
-        threadData[i].itemsIn = &itemsIn;
-        threadData[i].freeSlots = &freeSlots;
-        threadData[i].mutex = &mutex;
-        threadData[i].attori = attori;
-        threadData[i].attoriSize = attoriSize;
-
-        // Fa partire il thread
-        xpthread_create(&threads[i], NULL, &workerBody, &threadData[i], LINEFILE);
-    }
-
-    // Legge grafo.txt ed inserisce nel buffer, manda il segnale di termine ai consumatori
-    producerBody(file, buffer, &freeSlots, &itemsIn, n);
-    fclose(file);
-
-    // Aspetta che i consumatori terminino
-    for (size_t i = 0; i < n; i++) xpthread_join(threads[i], NULL, LINEFILE);
-
-    // Cleanup
-    xsem_destroy(&freeSlots, LINEFILE);
-    xsem_destroy(&itemsIn, LINEFILE);
-    xpthread_mutex_destroy(&mutex, LINEFILE);
-    free(buffer);
-    free(threads);
-    free(threadData);
-}
+#define _GNU_SOURCE
+
+#include "../CHeaders/graph.h"
+#include "../CHeaders/utilities.h"
+#include "../CHeaders/actors.h"
+#include "../CHeaders/xerrori.h"
+#include "../CHeaders/tokenizer.h"
+
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+/**
+ * @brief Cerca un codice nella tabella dei codici a partire da una posizione data.
+ * @details Usa una ricerca esponenziale seguita da una ricerca binaria, le liste dei coprotagonisti
+ *          in grafo.txt sono ordinate per codice, quindi ogni ricerca parte da dove è finita la precedente.
+ * @param codici Tabella ordinata dei codici.
+ * @param n Size della tabella.
+ * @param from Posizione da cui iniziare la ricerca.
+ * @param code Codice da cercare.
+ * @return Id denso del codice, -1 se non presente.
+ */
+static int gallopingSearch(const int* codici, size_t n, size_t from, int code) {
+    if (from >= n || codici[from] > code) from = 0; // Lista non ordinata, ricomincia dall'inizio
+
+    // Raddoppia il passo finché non supera il codice cercato
+    size_t low = from, step = 1, high = from;
+    while (high < n && codici[high] < code) {
+        low = high;
+        high = from + step;
+        step *= 2;
+    }
+    if (high > n) high = n;
+    if (high < n) high++;
+
+    // Ricerca binaria in [low, high)
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (codici[mid] < code) low = mid + 1;
+        else high = mid;
+    }
+
+    return (low < n && codici[low] == code) ? (int) low : -1;
+}
+
+
+/**
+ * @brief Primo passo: esegue il parsing dell'intestazione di una linea di grafo.txt e la salva in un record.
+ * @details Non richiede la tabella dei codici, quindi può essere eseguito mentre nomi.txt è ancora in lettura.
+ * @param line Inizio della linea in formato: actorCode\t#coprotagonisti\tcoprot1Code\t...\tcoprotNCode
+ * @param end Fine (esclusa) della linea.
+ * @param record Record da riempire con codice, numero di coprotagonisti e posizione della lista dei coprotagonisti.
+ */
+void countCoprotagonists(const char* line, const char* end, lineRecord* record) {
+    if (!nextInt(&line, end, &record -> codice) || !nextInt(&line, end, &record -> numcop) || record -> numcop < 0) xtermina(LINEFILE, "Linea di grafo.txt mal formattata nel thread consumatore: %ld", (long) gettid());
+
+    record -> id = -1;
+    record -> cop = line;
+    record -> end = end;
+}
+
+/**
+ * @brief Secondo passo: esegue il parsing dei coprotagonisti di una linea e li scrive, come id densi, nell'array vicini del grafo.
+ * @param record Record della linea, con l'id denso già calcolato.
+ * @param g Grafo in costruzione, con l'array offsets già calcolato.
+ */
+void updateCoprotagonists(const lineRecord* record, grafo* g) {
+    int code;
+    const char* line = record -> cop;
+
+    int* dest = g -> vicini + g -> offsets[record -> id];
+    int index = 0;
+    size_t from = 0;
+
+    // Parsa i codici dei coprotagonisti e li traduce in id densi
+    while (index < record -> numcop && nextInt(&line, record -> end, &code)) {
+        int coprotId = gallopingSearch(g -> codici, g -> numNodi, from, code);
+        if (coprotId == -1) xtermina(LINEFILE, "Coprotagonista %d dell'attore %d non presente in nomi.txt", code, record -> codice);
+
+        dest[index++] = coprotId;
+        from = coprotId;
+    }
+
+    // Check correttezza del file grafo.txt
+    if (index != record -> numcop) {
+        xtermina(LINEFILE, "Mismatch nel numero dei coprotagonisti dato e quello effettivo dell'attore: %d\n\tTrovati: %d\n\tPrevisti: %d", record -> codice, index, record -> numcop);
+    }
+}
+
+
+/**
+ * @brief Funzione eseguita dai thread consumatori, scorre il proprio blocco di grafo.txt.
+ * @details Nel primo passo (g NULL) salva un record per ogni linea, nel secondo scrive i coprotagonisti dei record.
+ * @arg Struct con i dati passata dal thread creatore.
+ */
+void* workerBody(void* arg) {
+    workerData* data = (workerData*) arg;
+
+    if (data -> g != NULL) {
+        for (size_t i = 0; i < data -> numRecords; i++) updateCoprotagonists(&(data -> records)[i], data -> g);
+        pthread_exit(NULL);
+    }
+
+    // Limite superiore al numero di linee del blocco
+    data -> records = malloc((countByte(data -> start, data -> end, '\n') + 1) * sizeof(lineRecord));
+    if (data -> records == NULL) xtermina(LINEFILE, "Allocazione dei record di grafo.txt fallita");
+
+    const char* line = data -> start;
+    size_t count = 0;
+
+    while (line < data -> end) {
+        const char* lineEnd = findByte(line, data -> end, '\n');
+
+        // Salta le linee vuote
+        if (lineEnd - line > 1 || (lineEnd - line == 1 && *line != '\r')) countCoprotagonists(line, lineEnd, &(data -> records)[count++]);
+
+        line = lineEnd + 1;
+    }
+
+    data -> numRecords = count;
+
+    pthread_exit(NULL);
+}
+
+
+/**
+ * @brief Esegue un passo di lettura di grafo.txt con un thread per blocco.
+ * @param threads Array dei thread.
+ * @param threadData Dati dei thread, con i blocchi già assegnati.
+ * @param n Numero dei thread.
+ * @param g Grafo in costruzione (secondo passo) oppure NULL (primo passo).
+ */
+static void startWorkers(pthread_t* threads, workerData* threadData, size_t n, grafo* g) {
+    for (size_t i = 0; i < n; i++) {
+        threadData[i].g = g;
+        xpthread_create(&threads[i], NULL, &workerBody, &threadData[i], LINEFILE);
+    }
+}
+
+/**
+ * @brief Attende la terminazione dei thread di un passo di lettura di grafo.txt.
+ * @param threads Array dei thread.
+ * @param n Numero dei thread.
+ */
+static void joinWorkers(pthread_t* threads, size_t n) {
+    for (size_t i = 0; i < n; i++) xpthread_join(threads[i], NULL, LINEFILE);
+}
+
+
+typedef struct {
+    char* filePath; // Percorso del file nomi.txt
+    size_t n; // Numero di thread lettori
+    arena* memoria; // Arena del grafo
+    tabellaAttori* tabella; // Tabella da riempire
+} actorsLoaderData;
+
+/**
+ * @brief Funzione eseguita dal thread che legge nomi.txt in parallelo al primo passo su grafo.txt.
+ * @param arg Struct actorsLoaderData.
+ */
+static void* actorsLoaderBody(void* arg) {
+    actorsLoaderData* data = (actorsLoaderData*) arg;
+
+    loadActors(data -> filePath, data -> n, data -> memoria, data -> tabella);
+
+    pthread_exit(NULL);
+}
+
+
+/**
+ * @brief Legge nomi.txt e grafo.txt costruendo direttamente la rappresentazione CSR del grafo.
+ * @details nomi.txt viene letto da loadActors() in un thread a parte, mentre i thread consumatori eseguono
+ *          il primo passo su grafo.txt: il file viene mappato in memoria e diviso in n blocchi allineati
+ *          all'inizio di una linea, per ogni linea viene salvato un record con codice, numero di coprotagonisti
+ *          e posizione della lista. Quando entrambi terminano i codici dei record vengono tradotti in id densi,
+ *          da cui viene calcolato l'array offsets, e il secondo passo scrive i coprotagonisti nell'array vicini.
+ * @param nomiPath Percorso del file nomi.txt
+ * @param grafoPath Percorso del file grafo.txt
+ * @param n Argomento numconsumatori passato da linea di comando e convertito ad intero.
+ * @return Grafo in formato CSR.
+ */
+grafo* processGraph(char* nomiPath, char* grafoPath, size_t n) {
+    if (n == 0) n = 1;
+
+    // Tutti i dati del grafo provengono da un'unica arena, usata dal thread lettore di nomi.txt fino al join
+    arena* memoria = arenaCreate();
+
+    // Lettura di nomi.txt in parallelo al primo passo
+    tabellaAttori tabella;
+    actorsLoaderData loaderData = {nomiPath, n, memoria, &tabella};
+    pthread_t loader;
+    xpthread_create(&loader, NULL, &actorsLoaderBody, &loaderData, LINEFILE);
+
+    // Mappa grafo.txt in memoria
+    size_t fileSize;
+    char* text = mapFile(grafoPath, &fileSize);
+
+    pthread_t* threads = malloc(n * sizeof(pthread_t));
+    workerData* threadData = malloc(n * sizeof(workerData));
+    const char** starts = malloc((n + 1) * sizeof(char*));
+    if (threads == NULL || threadData == NULL || starts == NULL) xtermina(LINEFILE, "Allocazione degli array dei threads fallita");
+
+    // Divide il file in blocchi che iniziano dopo un '\n'
+    splitBlocks(text, fileSize, n, starts);
+
+    for (size_t i = 0; i < n; i++) {
+        threadData[i].start = starts[i];
+        threadData[i].end = starts[i + 1];
+        threadData[i].records = NULL;
+        threadData[i].numRecords = 0;
+    }
+
+    // Primo passo: intestazioni delle linee
+    startWorkers(threads, threadData, n, NULL);
+    joinWorkers(threads, n);
+    xpthread_join(loader, NULL, LINEFILE);
+
+    grafo* g = createGraph(&tabella, memoria);
+
+    // Traduzione dei codici in id densi e gradi dei nodi, le linee di grafo.txt sono ordinate per codice
+    size_t* gradi = calloc(g -> numNodi + 1, sizeof(size_t));
+    if (gradi == NULL) xtermina(LINEFILE, "Allocazione dell'array dei gradi fallita");
+
+    size_t from = 0;
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < threadData[i].numRecords; j++) {
+            lineRecord* record = &(threadData[i].records)[j];
+
+            record -> id = gallopingSearch(g -> codici, g -> numNodi, from, record -> codice);
+            if (record -> id == -1) xtermina(LINEFILE, "Attore %d di grafo.txt non presente in nomi.txt", record -> codice);
+
+            gradi[record -> id] = record -> numcop;
+            from = record -> id;
+        }
+    }
+
+    // Somma prefissa dei gradi
+    g -> offsets[0] = 0;
+    for (size_t i = 0; i < g -> numNodi; i++) {
+        g -> offsets[i + 1] = g -> offsets[i] + gradi[i];
+        g -> attori[i] -> numcop = gradi[i];
+    }
+    g -> numArchi = g -> offsets[g -> numNodi];
+
+    g -> vicini = arenaAlloc(memoria, g -> numArchi * sizeof(int));
+
+    // Secondo passo: coprotagonisti scritti direttamente nell'array vicini
+    startWorkers(threads, threadData, n, g);
+    joinWorkers(threads, n);
+
+    // Cleanup
+    unmapFile(text, fileSize);
+    for (size_t i = 0; i < n; i++) free(threadData[i].records);
+    free(threads);
+    free(threadData);
+    free(starts);
+    free(gradi);
+
+    return g;
+}
+
+
+/**
+ * @brief Compara due attori per codice, per l'ordinamento con qsort().
+ * @param a Puntatore al primo puntatore ad attore.
+ * @param b Puntatore al secondo puntatore ad attore.
+ * @return Negativo, zero o positivo se il primo codice è minore, uguale o maggiore del secondo.
+ */
+static int compareAttoriCodice(const void* a, const void* b) {
+    int codiceA = (*(const attore* const*) a) -> codice;
+    int codiceB = (*(const attore* const*) b) -> codice;
+    return (codiceA > codiceB) - (codiceA < codiceB);
+}
+
+
+/**
+ * @brief Crea il grafo a partire dalla tabella degli attori letta da loadActors(), con le tabelle dei codici, degli anni e dei nomi.
+ * @details Il grafo adotta l'array degli attori e il pool dei nomi della tabella. Se nomi.txt non è ordinato per codice
+ *          gli attori vengono ordinati. L'array offsets viene allocato ma riempito da processGraph(), insieme all'array vicini.
+ * @param tabella Tabella degli attori.
+ * @param memoria Arena da cui allocare il grafo e i suoi array, che diventa di proprietà del grafo.
+ * @return Puntatore al grafo allocato nell'arena.
+ */
+grafo* createGraph(tabellaAttori* tabella, arena* memoria) {
+    attore** attori = tabella -> attori;
+    size_t n = tabella -> size;
+
+    grafo* g = arenaAlloc(memoria, sizeof(grafo));
+
+    // Gli id densi richiedono gli attori ordinati per codice
+    for (size_t i = 1; i < n; i++) {
+        if (attori[i - 1] -> codice > attori[i] -> codice) {
+            qsort(attori, n, sizeof(attore*), compareAttoriCodice);
+            break;
+        }
+    }
+
+    size_t* offsets = arenaCalloc(memoria, n + 1, sizeof(size_t));
+    size_t* nomiOffsets = arenaAlloc(memoria, (n + 1) * sizeof(size_t));
+    int* codici = arenaAlloc(memoria, n * sizeof(int));
+    int* anni = arenaAlloc(memoria, n * sizeof(int));
+
+    // Posizioni dei nomi nel pool, tabelle dei codici e degli anni
+    for (size_t i = 0; i < n; i++) {
+        nomiOffsets[i] = attori[i] -> nome - tabella -> nomi;
+        codici[i] = attori[i] -> codice;
+        anni[i] = attori[i] -> anno;
+    }
+    nomiOffsets[n] = tabella -> dimensioneNomi;
+
+    g -> attori = attori;
+    g -> memoria = memoria;
+    g -> numNodi = n;
+    g -> numArchi = 0;
+    g -> offsets = offsets;
+    g -> vicini = NULL;
+    g -> codici = codici;
+    g -> anni = anni;
+    g -> nomiOffsets = nomiOffsets;
+    g -> nomi = tabella -> nomi;
+    g -> dimensioneNomi = tabella -> dimensioneNomi;
+    g -> mappa = NULL;
+    g -> dimensioneMappa = 0;
+
+    return g;
+}
+
+
+/**
+ * @brief Traduce un codice IMDb nel corrispondente id denso.
+ * @param g Puntatore al grafo.
+ * @param code Codice dell'attore.
+ * @return Id denso dell'attore, -1 se il codice non è presente nel grafo.
+ */
+int nodeIndex(grafo* g, int code) {
+    size_t low = 0, high = g -> numNodi;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (g -> codici[mid] < code) low = mid + 1;
+        else high = mid;
+    }
+
+    return (low < g -> numNodi && g -> codici[low] == code) ? (int) low : -1;
+}
+
+
+/**
+ * @brief Restituisce il nome di un nodo.
+ * @param g Puntatore al grafo.
+ * @param id Id denso del nodo.
+ * @return Puntatore al nome nel pool dei nomi del grafo.
+ */
+char* nodeName(grafo* g, int id) {
+    return g -> nomi + g -> nomiOffsets[id];
+}
+
+
+/**
+ * @brief Dealloca il grafo rilasciando la sua arena, oppure rimuove la mappatura se il grafo proviene da uno snapshot.
+ * @param g Puntatore al grafo.
+ */
+void freeGrafo(grafo* g) {
+    if (!g) return;
+
+    if (g -> mappa != NULL) {
+        if (munmap(g -> mappa, g -> dimensioneMappa) == -1) xtermina(LINEFILE, "munmap dello snapshot fallita");
+        free(g);
+        return;
+    }
+
+    // Il grafo stesso, gli attori, i nomi e tutti gli array provengono dall'arena
+    arenaFree(g -> memoria);
+}
@@ -0,0 +1,501 @@
+#define _GNU_SOURCE
+
+#include "../CHeaders/landmarks.h"
+#include "../CHeaders/msbfs.h"
+#include "../CHeaders/bfs.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/times.h>
+
+_Static_assert(LANDMARK_INF == MSBFS_UNREACHED, "Le distanze dei landmark vengono copiate dalla BFS multi-sorgente");
+_Static_assert(LANDMARK_MAX <= MSBFS_WIDTH, "I landmark di ogni passo devono stare in una BFS multi-sorgente");
+
+static const grafo* sortGraph; // Grafo usato da compareByDegree()
+
+/**
+ * @brief Compara due nodi per grado decrescente, per l'ordinamento con qsort().
+ * @param x Puntatore al primo id denso.
+ * @param y Puntatore al secondo id denso.
+ * @return Negativo se il primo nodo ha grado maggiore.
+ */
+static int compareByDegree(const void* x, const void* y) {
+    int u = *(const int*) x, v = *(const int*) y;
+    size_t du = sortGraph -> offsets[u + 1] - sortGraph -> offsets[u];
+    size_t dv = sortGraph -> offsets[v + 1] - sortGraph -> offsets[v];
+    return (du < dv) - (du > dv);
+}
+
+/**
+ * @brief Sceglie fino a count landmark tra i candidati in ordine, scartando quelli già scelti o adiacenti ad un landmark.
+ * @param g Grafo degli attori.
+ * @param candidates Id densi dei candidati in ordine di preferenza.
+ * @param numCandidates Numero di candidati.
+ * @param count Numero di landmark da scegliere.
+ * @param excluded Marcatori dei nodi già scelti o adiacenti, aggiornato.
+ * @param chosen Array in cui scrivere i landmark scelti.
+ * @return Numero di landmark scelti.
+ */
+static size_t pickSpread(grafo* g, const int* candidates, size_t numCandidates, size_t count, bool* excluded, int* chosen) {
+    size_t picked = 0;
+
+    for (size_t i = 0; i < numCandidates && picked < count; i++) {
+        int v = candidates[i];
+        if (excluded[v]) continue;
+
+        chosen[picked++] = v;
+        excluded[v] = true;
+        for (size_t j = g -> offsets[v]; j < g -> offsets[v + 1]; j++) excluded[g -> vicini[j]] = true;
+    }
+
+    return picked;
+}
+
+/**
+ * @brief Esegue una BFS multi-sorgente dai landmark indicati e copia le distanze nelle colonne dell'indice.
+ * @param g Grafo degli attori.
+ * @param ms Contesto della BFS multi-sorgente.
+ * @param index Indice in costruzione.
+ * @param first Colonna del primo landmark del passo.
+ * @param count Numero di landmark del passo.
+ */
+static void fillColumns(grafo* g, msbfsContext* ms, landmarkIndex* index, size_t first, size_t count) {
+    if (count == 0) return;
+
+    msbfsRun(g, ms, index -> landmarks + first, count, NULL, 0);
+    if (ms -> levels > MSBFS_MAX_LEVEL) index -> saturo = true;
+
+    for (size_t l = 0; l < count; l++) {
+        for (size_t v = 0; v < g -> numNodi; v++) index -> dist[v * index -> k + first + l] = msbfsDistance(ms, (int) l, (int) v);
+    }
+}
+
+/**
+ * @brief Calcola l'indice dei landmark: k nodi con la distanza BFS da ognuno di essi verso tutti i nodi.
+ * @details Metà dei landmark sono i nodi di grado massimo (centrali, danno buoni limiti superiori d(a, L) + d(L, b)),
+ *          l'altra metà i nodi più lontani da essi (periferici, danno buoni limiti inferiori |d(a, L) - d(b, L)|).
+ *          I landmark adiacenti ad uno già scelto vengono scartati. Ogni metà richiede una sola BFS multi-sorgente.
+ * @param g Grafo degli attori.
+ * @param k Numero di landmark richiesti, al più LANDMARK_MAX.
+ * @return Puntatore all'indice, NULL se il grafo è vuoto.
+ */
+landmarkIndex* landmarkBuild(grafo* g, size_t k) {
+    if (k > LANDMARK_MAX) k = LANDMARK_MAX;
+    if (k > g -> numNodi) k = g -> numNodi;
+    if (k == 0) return NULL;
+
+    landmarkIndex* index = malloc(sizeof(landmarkIndex));
+    int* order = malloc(g -> numNodi * sizeof(int));
+    bool* excluded = calloc(g -> numNodi, sizeof(bool));
+    if (index == NULL || order == NULL || excluded == NULL) xtermina(LINEFILE, "Allocazione dell'indice dei landmark fallita");
+
+    index -> dist = malloc(g -> numNodi * k * sizeof(uint8_t));
+    if (index -> dist == NULL) xtermina(LINEFILE, "Allocazione delle distanze dei landmark fallita");
+
+    index -> k = k;
+    index -> numNodi = g -> numNodi;
+    index -> saturo = false;
+    index -> mappa = NULL;
+    index -> dimensioneMappa = 0;
+
+    msbfsContext* ms = msbfsContextCreate(g -> numNodi);
+
+    // Prima metà: nodi di grado massimo
+    for (size_t v = 0; v < g -> numNodi; v++) order[v] = (int) v;
+    sortGraph = g;
+    qsort(order, g -> numNodi, sizeof(int), compareByDegree);
+
+    size_t hubs = pickSpread(g, order, g -> numNodi, (k + 1) / 2, excluded, index -> landmarks);
+    fillColumns(g, ms, index, 0, hubs);
+
+    // Seconda metà: nodi raggiunti da tutti i landmark centrali con la massima distanza totale da essi
+    size_t candidates = 0;
+    uint32_t* score = malloc(g -> numNodi * sizeof(uint32_t));
+    if (score == NULL) xtermina(LINEFILE, "Allocazione dei punteggi dei landmark fallita");
+
+    for (size_t v = 0; v < g -> numNodi; v++) {
+        uint32_t sum = 0;
+        bool reached = true;
+
+        for (size_t l = 0; l < hubs && reached; l++) {
+            uint8_t d = index -> dist[v * k + l];
+            if (d == LANDMARK_INF) reached = false;
+            sum += d;
+        }
+
+        if (reached) {
+            score[v] = sum;
+            order[candidates++] = (int) v;
+        }
+    }
+
+    // Ordinamento per punteggio decrescente, i punteggi sono piccoli: counting sort
+    uint32_t maxScore = 0;
+    for (size_t i = 0; i < candidates; i++) if (score[order[i]] > maxScore) maxScore = score[order[i]];
+
+    size_t* counts = calloc((size_t) maxScore + 2, sizeof(size_t));
+    int* sorted = malloc((candidates > 0 ? candidates : 1) * sizeof(int));
+    if (counts == NULL || sorted == NULL) xtermina(LINEFILE, "Allocazione dell'ordinamento dei landmark fallita");
+
+    for (size_t i = 0; i < candidates; i++) counts[maxScore - score[order[i]] + 1]++;
+    for (size_t s = 1; s <= maxScore + 1; s++) counts[s] += counts[s - 1];
+    for (size_t i = 0; i < candidates; i++) sorted[counts[maxScore - score[order[i]]]++] = order[i];
+
+    size_t peripheral = pickSpread(g, sorted, candidates, k - hubs, excluded, index -> landmarks + hubs);
+
+    // Se non ci sono abbastanza nodi periferici distinti completa con altri nodi di grado massimo
+    if (hubs + peripheral < k) {
+        for (size_t v = 0; v < g -> numNodi; v++) order[v] = (int) v;
+        qsort(order, g -> numNodi, sizeof(int), compareByDegree);
+        memset(excluded, 0, g -> numNodi * sizeof(bool));
+        for (size_t l = 0; l < hubs + peripheral; l++) excluded[index -> landmarks[l]] = true;
+
+        for (size_t i = 0; i < g -> numNodi && hubs + peripheral < k; i++) {
+            if (!excluded[order[i]]) index -> landmarks[hubs + peripheral++] = order[i];
+        }
+    }
+
+    fillColumns(g, ms, index, hubs, peripheral);
+
+    msbfsContextFree(ms);
+    free(order);
+    free(excluded);
+    free(score);
+    free(counts);
+    free(sorted);
+
+    return index;
+}
+
+/**
+ * @brief Controlla se il file dei landmark esiste e non è più vecchio dei file da cui è stato caricato il grafo.
+ * @param path Percorso del file dei landmark.
+ * @param nomiPath Percorso di nomi.txt (può essere NULL).
+ * @param grafoPath Percorso di grafo.txt (può essere NULL).
+ * @param snapshotPath Percorso dello snapshot (può essere NULL).
+ * @return true se il file può essere caricato, false altrimenti.
+ */
+bool landmarkIsUsable(const char* path, const char* nomiPath, const char* grafoPath, const char* snapshotPath) {
+    struct stat index, source;
+
+    if (stat(path, &index) == -1) return false;
+
+    const char* sources[] = { nomiPath, grafoPath, snapshotPath };
+    for (size_t i = 0; i < 3; i++) {
+        if (sources[i] != NULL && stat(sources[i], &source) == 0 && source.st_mtime > index.st_mtime) return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Mappa in sola lettura il file dei landmark, controllando che sia stato calcolato per questo grafo.
+ * @param g Grafo degli attori.
+ * @param path Percorso del file.
+ * @param k Numero di landmark richiesti.
+ * @return Puntatore all'indice, NULL se il file non esiste, non è valido o ha un numero diverso di landmark.
+ */
+landmarkIndex* landmarkLoad(grafo* g, const char* path, size_t k) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t) st.st_size < sizeof(landmarkHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // La mappatura resta valida dopo la chiusura
+    if (map == MAP_FAILED) xtermina(LINEFILE, "mmap del file dei landmark %s fallita", path);
+
+    const landmarkHeader* header = (const landmarkHeader*) map;
+
+    bool valid = memcmp(header -> magic, LANDMARK_MAGIC, sizeof(header -> magic)) == 0
+        && header -> versione == LANDMARK_VERSION
+        && header -> k == (k > LANDMARK_MAX ? LANDMARK_MAX : k)
+        && header -> numNodi == g -> numNodi
+        && header -> numArchi == g -> numArchi
+        && (uint64_t) st.st_size == sizeof(landmarkHeader) + header -> numNodi * header -> k;
+
+    for (uint32_t l = 0; valid && l < header -> k; l++) valid = header -> landmarks[l] >= 0 && (uint64_t) header -> landmarks[l] < header -> numNodi;
+
+    if (!valid) {
+        fprintf(stderr, "File dei landmark %s non valido o calcolato per un altro grafo.\n", path);
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    landmarkIndex* index = malloc(sizeof(landmarkIndex));
+    if (index == NULL) xtermina(LINEFILE, "Allocazione dell'indice dei landmark fallita");
+
+    index -> k = header -> k;
+    index -> numNodi = header -> numNodi;
+    for (size_t l = 0; l < index -> k; l++) index -> landmarks[l] = header -> landmarks[l];
+    index -> dist = (uint8_t*) map + sizeof(landmarkHeader);
+    index -> saturo = header -> saturo != 0;
+    index -> mappa = map;
+    index -> dimensioneMappa = st.st_size;
+
+    return index;
+}
+
+/**
+ * @brief Salva l'indice dei landmark, scrivendo su un file temporaneo che poi viene rinominato.
+ * @details Un errore di scrittura non è fatale: l'indice verrà ricalcolato al prossimo avvio.
+ * @param index Indice da salvare.
+ * @param g Grafo per cui è stato calcolato.
+ * @param path Percorso del file.
+ */
+void landmarkSave(landmarkIndex* index, grafo* g, const char* path) {
+    landmarkHeader header;
+    memset(&header, 0, sizeof(header));
+
+    memcpy(header.magic, LANDMARK_MAGIC, sizeof(header.magic));
+    header.versione = LANDMARK_VERSION;
+    header.k = index -> k;
+    header.numNodi = g -> numNodi;
+    header.numArchi = g -> numArchi;
+    header.saturo = index -> saturo;
+    for (size_t l = 0; l < index -> k; l++) header.landmarks[l] = index -> landmarks[l];
+
+    char* tempPath = NULL;
+    if (asprintf(&tempPath, "%s.tmp", path) == -1) xtermina(LINEFILE, "Allocazione del percorso temporaneo dei landmark fallita");
+
+    FILE* file = fopen(tempPath, "wb");
+    size_t size = index -> numNodi * index -> k;
+
+    bool ok = file != NULL
+        && fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(index -> dist, 1, size, file) == size;
+
+    if (file != NULL && fclose(file) != 0) ok = false;
+    if (ok && rename(tempPath, path) == -1) ok = false;
+
+    if (ok) fprintf(stderr, "Indice dei landmark salvato in %s.\n", path);
+    else {
+        fprintf(stderr, "Salvataggio dell'indice dei landmark in %s fallito, verrà ricalcolato al prossimo avvio.\n", path);
+        unlink(tempPath);
+    }
+
+    free(tempPath);
+}
+
+/**
+ * @brief Limiti inferiore e superiore della distanza tra due nodi, in tempo O(k).
+ * @details Per la disuguaglianza triangolare |d(a, L) - d(b, L)| <= d(a, b) <= d(a, L) + d(L, b) per ogni landmark L.
+ *          Se un landmark raggiunge solo uno dei due nodi, i nodi sono in componenti diverse.
+ * @param index Indice dei landmark.
+ * @param a Id denso del primo nodo.
+ * @param b Id denso del secondo nodo.
+ * @param lower Impostato al limite inferiore, LANDMARK_NO_PATH se non esiste un cammino.
+ * @param upper Impostato al limite superiore, INT32_MAX se nessun landmark raggiunge entrambi i nodi.
+ */
+void landmarkBounds(const landmarkIndex* index, int a, int b, int* lower, int* upper) {
+    const uint8_t* da = index -> dist + (size_t) a * index -> k;
+    const uint8_t* db = index -> dist + (size_t) b * index -> k;
+
+    int low = 0, high = INT32_MAX;
+
+    for (size_t l = 0; l < index -> k; l++) {
+        if (da[l] == LANDMARK_INF || db[l] == LANDMARK_INF) {
+            if (da[l] != db[l] && !index -> saturo) low = LANDMARK_NO_PATH;
+            continue;
+        }
+
+        int difference = da[l] > db[l] ? da[l] - db[l] : db[l] - da[l];
+        if (difference > low) low = difference;
+        if (da[l] + db[l] < high) high = da[l] + db[l];
+    }
+
+    if (a == b) low = high = 0;
+
+    *lower = low;
+    *upper = high;
+}
+
+/**
+ * @brief Euristica ammissibile e consistente per la ricerca A*: limite inferiore della distanza da v al target.
+ * @param index Indice dei landmark.
+ * @param v Id denso del nodo.
+ * @param target Riga delle distanze del target dai landmark.
+ * @return Limite inferiore, LANDMARK_NO_PATH se v non può raggiungere il target.
+ */
+int landmarkHeuristic(const landmarkIndex* index, int v, const uint8_t* target) {
+    const uint8_t* dv = index -> dist + (size_t) v * index -> k;
+    int h = 0;
+
+    for (size_t l = 0; l < index -> k; l++) {
+        if (dv[l] == LANDMARK_INF || target[l] == LANDMARK_INF) {
+            if (dv[l] != target[l]) return LANDMARK_NO_PATH;
+            continue;
+        }
+
+        int difference = dv[l] > target[l] ? dv[l] - target[l] : target[l] - dv[l];
+        if (difference > h) h = difference;
+    }
+
+    return h;
+}
+
+/**
+ * @brief Scende dal nodo from verso il landmark l passando ogni volta ad un vicino più vicino di uno al landmark.
+ * @param g Grafo degli attori.
+ * @param index Indice dei landmark.
+ * @param l Colonna del landmark.
+ * @param from Id denso del nodo di partenza.
+ * @param path Array in cui scrivere i nodi da from al landmark compresi.
+ * @return Numero di nodi scritti.
+ */
+static size_t descendToLandmark(grafo* g, const landmarkIndex* index, size_t l, int from, int* path) {
+    size_t count = 0;
+    int current = from;
+
+    path[count++] = current;
+
+    while (index -> dist[(size_t) current * index -> k + l] > 0) {
+        uint8_t d = index -> dist[(size_t) current * index -> k + l];
+
+        size_t i = g -> offsets[current];
+        while (index -> dist[(size_t) g -> vicini[i] * index -> k + l] != d - 1) i++; // Esiste sempre
+
+        current = g -> vicini[i];
+        path[count++] = current;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Se i limiti della distanza coincidono, ricava un cammino minimo passando per il landmark che li rende esatti.
+ * @details Il cammino a -> L -> b ha lunghezza pari al limite superiore, che coincide con quello inferiore, quindi è minimo.
+ *          Costa O(lunghezza * grado), senza nessuna ricerca.
+ * @param g Grafo degli attori.
+ * @param index Indice dei landmark.
+ * @param a Id denso del nodo iniziale.
+ * @param b Id denso del nodo destinazione.
+ * @param path Array, di almeno numNodi elementi, in cui scrivere il cammino da a a b.
+ * @return Numero di nodi del cammino, 0 se i limiti non coincidono.
+ */
+size_t landmarkPath(grafo* g, const landmarkIndex* index, int a, int b, int* path) {
+    if (index -> saturo) return 0;
+
+    int lower, upper;
+    landmarkBounds(index, a, b, &lower, &upper);
+    if (lower != upper || upper == INT32_MAX) return 0;
+
+    // Landmark su un cammino minimo
+    size_t l = 0;
+    while (index -> dist[(size_t) a * index -> k + l] + index -> dist[(size_t) b * index -> k + l] != upper) l++;
+
+    size_t first = descendToLandmark(g, index, l, a, path);
+    size_t second = descendToLandmark(g, index, l, b, path + first);
+
+    // Il tratto da b al landmark va invertito, senza ripetere il landmark
+    int* tail = path + first;
+    for (size_t i = 0; i < second / 2; i++) {
+        int tmp = tail[i];
+        tail[i] = tail[second - 1 - i];
+        tail[second - 1 - i] = tmp;
+    }
+    memmove(tail, tail + 1, (second - 1) * sizeof(int));
+
+    return first + second - 1;
+}
+
+/**
+ * @brief Stampa su stderr tempo di costruzione, memoria occupata e accuratezza dei limiti su coppie casuali.
+ * @param g Grafo degli attori.
+ * @param index Indice dei landmark.
+ * @param seconds Tempo di costruzione o caricamento dell'indice.
+ */
+void landmarkReport(grafo* g, const landmarkIndex* index, double seconds) {
+    fprintf(stderr, "Indice di %zu landmark pronto in %.3f secondi, %.1f MB (%zu byte per nodo)%s.\n",
+            index -> k, seconds, (double) index -> numNodi * index -> k / (1 << 20), index -> k, index -> saturo ? ", distanze oltre 254 non memorizzate" : "");
+
+    if (g -> numNodi < 2) return;
+
+    bfsContext* ctx = bfsContextCreate(g -> numNodi);
+    unsigned int seed = 42;
+
+    size_t connected = 0, exact = 0, disconnected = 0, detected = 0, lowerGap = 0, upperGap = 0;
+
+    for (size_t i = 0; i < LANDMARK_SAMPLE_PAIRS; i++) {
+        int a = rand_r(&seed) % g -> numNodi;
+        int b = rand_r(&seed) % g -> numNodi;
+
+        int lower, upper;
+        landmarkBounds(index, a, b, &lower, &upper);
+
+        if (!bfsBidirectional(g, ctx, a, b)) {
+            disconnected++;
+            if (lower == LANDMARK_NO_PATH) detected++;
+            continue;
+        }
+
+        int distance = (int) bfsExtractPath(ctx, b) - 1;
+        connected++;
+
+        if (lower == distance && upper == distance) exact++;
+        lowerGap += distance - lower;
+        if (upper != INT32_MAX) upperGap += upper - distance;
+    }
+
+    fprintf(stderr, "Accuratezza su %d coppie casuali: %zu connesse, limiti esatti per %zu (%.1f%%), scarto medio %.2f (inferiore) e %.2f (superiore); "
+            "%zu/%zu coppie non connesse riconosciute.\n", LANDMARK_SAMPLE_PAIRS, connected, exact, connected > 0 ? 100.0 * exact / connected : 0.0,
+            connected > 0 ? (double) lowerGap / connected : 0.0, connected > 0 ? (double) upperGap / connected : 0.0, detected, disconnected);
+
+    bfsContextFree(ctx);
+}
+
+/**
+ * @brief Carica l'indice dei landmark salvato accanto al grafo oppure lo calcola e lo salva, poi stampa il resoconto.
+ * @details Il file è snapshot.landmark se il grafo usa uno snapshot, altrimenti grafo.txt.landmark.
+ * @param g Grafo degli attori.
+ * @param k Numero di landmark, 0 per non usare l'indice.
+ * @param nomiPath Percorso di nomi.txt (può essere NULL).
+ * @param grafoPath Percorso di grafo.txt (può essere NULL).
+ * @param snapshotPath Percorso dello snapshot (può essere NULL).
+ * @return Puntatore all'indice, NULL se k è 0.
+ */
+landmarkIndex* landmarkPrepare(grafo* g, size_t k, const char* nomiPath, const char* grafoPath, const char* snapshotPath) {
+    if (k == 0) return NULL;
+
+    clock_t timeStart = times(NULL);
+
+    char* path = NULL;
+    if (asprintf(&path, "%s.landmark", snapshotPath != NULL ? snapshotPath : grafoPath) == -1) xtermina(LINEFILE, "Allocazione del percorso dei landmark fallita");
+
+    landmarkIndex* index = NULL;
+    if (landmarkIsUsable(path, nomiPath, grafoPath, snapshotPath)) index = landmarkLoad(g, path, k);
+
+    if (index != NULL) fprintf(stderr, "Indice dei landmark caricato da %s.\n", path);
+    else {
+        index = landmarkBuild(g, k);
+        if (index != NULL) landmarkSave(index, g, path);
+    }
+
+    if (index != NULL) landmarkReport(g, index, (double)(times(NULL) - timeStart) / sysconf(_SC_CLK_TCK));
+
+    free(path);
+    return index;
+}
+
+/**
+ * @brief Dealloca l'indice dei landmark oppure ne rimuove la mappatura.
+ * @param index Puntatore all'indice.
+ */
+void landmarkFree(landmarkIndex* index) {
+    if (!index) return;
+
+    if (index -> mappa != NULL) munmap(index -> mappa, index -> dimensioneMappa);
+    else free(index -> dist);
+
+    free(index);
+}
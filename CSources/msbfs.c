@@ -0,0 +1,204 @@
+#define _GNU_SOURCE
+
+#include "../CHeaders/msbfs.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Crea un contesto per la BFS multi-sorgente, riutilizzabile per più lotti.
+ * @details Occupa msbfsContextBytes(n) byte: 3 * 8 byte di bitmap più MSBFS_WIDTH byte di distanze per nodo.
+ * @param n Numero di nodi del grafo.
+ * @return Puntatore al contesto creato.
+ */
+msbfsContext* msbfsContextCreate(size_t n) {
+    msbfsContext* ctx = malloc(sizeof(msbfsContext));
+    if (ctx == NULL) xtermina(LINEFILE, "Allocazione del contesto della BFS multi-sorgente fallita");
+
+    size_t size = n > 0 ? n : 1;
+
+    ctx -> seen = malloc(size * sizeof(uint64_t));
+    ctx -> visit = malloc(size * sizeof(uint64_t));
+    ctx -> visitNext = malloc(size * sizeof(uint64_t));
+    ctx -> dist = malloc(size * MSBFS_WIDTH * sizeof(uint8_t));
+    if (ctx -> seen == NULL || ctx -> visit == NULL || ctx -> visitNext == NULL || ctx -> dist == NULL) {
+        xtermina(LINEFILE, "Allocazione degli array della BFS multi-sorgente fallita");
+    }
+
+    ctx -> n = n;
+    ctx -> levels = 0;
+
+    return ctx;
+}
+
+/**
+ * @brief Memoria occupata dagli array di un contesto della BFS multi-sorgente.
+ * @param n Numero di nodi del grafo.
+ * @return Byte allocati da msbfsContextCreate(n).
+ */
+size_t msbfsContextBytes(size_t n) {
+    return (n > 0 ? n : 1) * (3 * sizeof(uint64_t) + MSBFS_WIDTH * sizeof(uint8_t));
+}
+
+/**
+ * @brief Dealloca un contesto della BFS multi-sorgente.
+ * @param ctx Puntatore al contesto.
+ */
+void msbfsContextFree(msbfsContext* ctx) {
+    if (!ctx) return;
+
+    free(ctx -> seen);
+    free(ctx -> visit);
+    free(ctx -> visitNext);
+    free(ctx -> dist);
+    free(ctx);
+}
+
+/**
+ * @brief Controlla se tutti i nodi da raggiungere sono già stati raggiunti dalle rispettive sorgenti.
+ * @param ctx Contesto della visita.
+ * @param targets Nodi da raggiungere.
+ * @param numTargets Numero di nodi da raggiungere.
+ * @param firstPending Indice del primo nodo non ancora raggiunto, aggiornato per non ricontrollare i precedenti.
+ * @return true se sono stati raggiunti tutti.
+ */
+static bool targetsReached(msbfsContext* ctx, const msbfsTarget* targets, size_t numTargets, size_t* firstPending) {
+    while (*firstPending < numTargets) {
+        const msbfsTarget* t = &targets[*firstPending];
+        if (!(ctx -> seen[t -> node] & (1ULL << t -> source))) return false;
+        (*firstPending)++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief BFS multi-sorgente bit-parallela (MS-BFS): visita il grafo da fino a 64 sorgenti con un'unica scansione per livello.
+ * @details Ogni nodo ha una parola per i visitati e una per la frontiera, il bit s corrisponde alla sorgente s.
+ *          Un arco (v, u) viene esaminato una sola volta per livello per tutte le sorgenti che hanno v in frontiera,
+ *          e visit[v] & ~seen[u] dà in un'unica operazione le sorgenti che raggiungono u per la prima volta.
+ *          Se targets non è vuoto la visita termina appena tutte le coppie (sorgente, nodo) sono state raggiunte,
+ *          altrimenti prosegue fino a visitare le intere componenti delle sorgenti.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto del thread chiamante.
+ * @param sources Id densi delle sorgenti, al più MSBFS_WIDTH e distinti.
+ * @param numSources Numero di sorgenti.
+ * @param targets Nodi da raggiungere, con l'indice della sorgente nel lotto (può essere NULL).
+ * @param numTargets Numero di nodi da raggiungere.
+ */
+void msbfsRun(grafo* g, msbfsContext* ctx, const int* sources, size_t numSources, const msbfsTarget* targets, size_t numTargets) {
+    if (numSources > MSBFS_WIDTH) xtermina(LINEFILE, "msbfsRun() chiamata con %zu sorgenti, massimo %d", numSources, MSBFS_WIDTH);
+
+    size_t n = g -> numNodi;
+    uint64_t* seen = ctx -> seen;
+    uint64_t* visit = ctx -> visit;
+    uint64_t* visitNext = ctx -> visitNext;
+
+    memset(seen, 0, n * sizeof(uint64_t));
+    memset(visit, 0, n * sizeof(uint64_t));
+    memset(visitNext, 0, n * sizeof(uint64_t));
+    memset(ctx -> dist, MSBFS_UNREACHED, numSources * n);
+
+    for (size_t s = 0; s < numSources; s++) {
+        seen[sources[s]] |= 1ULL << s;
+        visit[sources[s]] |= 1ULL << s;
+        ctx -> dist[s * n + sources[s]] = 0;
+    }
+
+    size_t level = 0, firstPending = 0;
+    bool active = numSources > 0;
+
+    while (active) {
+        if (numTargets > 0 && targetsReached(ctx, targets, numTargets, &firstPending)) break;
+
+        level++;
+        active = false;
+
+        for (size_t v = 0; v < n; v++) {
+            uint64_t frontier = visit[v];
+            if (frontier == 0) continue;
+
+            for (size_t i = g -> offsets[v]; i < g -> offsets[v + 1]; i++) {
+                int u = g -> vicini[i];
+
+                uint64_t newBits = frontier & ~seen[u];
+                if (newBits == 0) continue;
+
+                visitNext[u] |= newBits;
+                seen[u] |= newBits;
+                active = true;
+
+                // Distanze per sorgente, oltre MSBFS_MAX_LEVEL il nodo resta MSBFS_UNREACHED ma è comunque in seen
+                if (level <= MSBFS_MAX_LEVEL) {
+                    while (newBits) {
+                        ctx -> dist[(size_t) __builtin_ctzll(newBits) * n + u] = (uint8_t) level;
+                        newBits &= newBits - 1;
+                    }
+                }
+            }
+        }
+
+        // La frontiera successiva diventa quella corrente, la vecchia viene azzerata per il prossimo livello
+        uint64_t* temp = visit;
+        visit = visitNext;
+        visitNext = temp;
+        memset(visitNext, 0, n * sizeof(uint64_t));
+    }
+
+    ctx -> visit = visit;
+    ctx -> visitNext = visitNext;
+    ctx -> levels = level;
+}
+
+/**
+ * @brief Controlla se un nodo è stato raggiunto da una sorgente nell'ultima visita.
+ * @param ctx Contesto della visita.
+ * @param source Indice della sorgente nel lotto.
+ * @param node Id denso del nodo.
+ * @return true se il nodo è stato raggiunto.
+ */
+bool msbfsReached(msbfsContext* ctx, int source, int node) {
+    return (ctx -> seen[node] >> source) & 1;
+}
+
+/**
+ * @brief Restituisce la distanza di un nodo da una sorgente nell'ultima visita.
+ * @param ctx Contesto della visita.
+ * @param source Indice della sorgente nel lotto.
+ * @param node Id denso del nodo.
+ * @return Distanza, MSBFS_UNREACHED se non raggiunto o oltre MSBFS_MAX_LEVEL.
+ */
+uint8_t msbfsDistance(msbfsContext* ctx, int source, int node) {
+    return ctx -> dist[(size_t) source * ctx -> n + node];
+}
+
+/**
+ * @brief Ricostruisce un cammino minimo dalla sorgente a target usando solo le distanze.
+ * @details Partendo da target passa ogni volta ad un vicino a distanza inferiore di uno, fino alla sorgente.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto della visita.
+ * @param source Indice della sorgente nel lotto.
+ * @param target Id denso del nodo destinazione.
+ * @param path Array, di almeno MSBFS_MAX_LEVEL + 1 elementi, in cui scrivere il cammino dalla sorgente a target.
+ * @return Numero di nodi del cammino, 0 se target non ha una distanza memorizzata.
+ */
+size_t msbfsExtractPath(grafo* g, msbfsContext* ctx, int source, int target, int* path) {
+    const uint8_t* dist = ctx -> dist + (size_t) source * ctx -> n;
+
+    uint8_t d = dist[target];
+    if (d == MSBFS_UNREACHED) return 0;
+
+    int current = target;
+    path[d] = target;
+
+    for (int k = d - 1; k >= 0; k--) {
+        size_t i = g -> offsets[current];
+        while (dist[g -> vicini[i]] != k) i++; // Esiste sempre un vicino a distanza k
+
+        current = g -> vicini[i];
+        path[k] = current;
+    }
+
+    return (size_t) d + 1;
+}
@@ -0,0 +1,203 @@
+#define _GNU_SOURCE
+
+#include "../CHeaders/options.h"
+#include "../CHeaders/analysis.h"
+#include "../CHeaders/centrality.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h> // Per SIZE_MAX
+#include <ctype.h> // Usato per isdigit()
+#include <unistd.h> // Per sysconf()
+#include <errno.h> // Per ERANGE
+
+/**
+ * @brief Converte il valore di un'opzione in un intero positivo.
+ * @details Un valore che non sta in un size_t termina il programma invece di essere troncato.
+ * @param value Stringa da convertire.
+ * @param result Puntatore al risultato.
+ * @return true se la stringa è un intero positivo valido, false altrimenti.
+ */
+static bool parsePositive(const char* value, size_t* result) {
+    if (*value == '\0') return false;
+
+    for (const char* c = value; *c; c++) {
+        if (!isdigit((unsigned char) *c)) return false;
+    }
+
+    char* endptr;
+    errno = 0;
+    unsigned long long n = strtoull(value, &endptr, 10);
+
+    if (errno == ERANGE || n > SIZE_MAX) {
+        if (errno == 0) errno = ERANGE;
+        xtermina(LINEFILE, "Valore %s dell'opzione troppo grande", value);
+    }
+    if (*endptr != '\0' || n == 0) return false;
+
+    *result = (size_t) n;
+    return true;
+}
+
+/**
+ * @brief Converte il valore di un'opzione in un intero non negativo.
+ * @param value Stringa da convertire.
+ * @param result Puntatore al risultato.
+ * @return true se la stringa è un intero non negativo valido, false altrimenti.
+ */
+static bool parseNonNegative(const char* value, size_t* result) {
+    if (strcmp(value, "0") == 0) {
+        *result = 0;
+        return true;
+    }
+
+    return parsePositive(value, result);
+}
+
+/**
+ * @brief Inizializza le opzioni con i valori di default.
+ * @param opts Puntatore alle opzioni.
+ */
+void defaultOptions(opzioni* opts) {
+    opts -> fileNomi = NULL;
+    opts -> fileGrafo = NULL;
+    opts -> numConsumatori = 0;
+    opts -> snapshot = NULL;
+    opts -> modalitaRicerca = BFS_BIDIREZIONALE;
+
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    opts -> numThread = cores > 0 ? (size_t) cores : 1;
+    opts -> dimensioneCoda = DEFAULT_JOB_QUEUE_SIZE;
+    opts -> memoriaCacheCammini = (size_t) DEFAULT_PATH_CACHE_MB << 20;
+    opts -> numAlberi = 0;
+    opts -> numCammini = 0;
+    opts -> fileBatch = NULL;
+    opts -> numLandmark = 0;
+    opts -> numPipe = 0;
+    opts -> fileRisposte = NULL;
+    opts -> formatoRisposte = RISPOSTE_TSV;
+    opts -> analisi = false;
+    opts -> centralita = false;
+    opts -> numCampioni = 0;
+}
+
+/**
+ * @brief Esegue il parsing di un'opzione facoltativa passata da linea di comando.
+ * @param arg Argomento nella forma --nome=valore.
+ * @param opts Puntatore alle opzioni da aggiornare.
+ * @return true se l'opzione è valida, false altrimenti.
+ */
+bool parseOption(char* arg, opzioni* opts) {
+    if (strncmp(arg, "--bfs=", 6) == 0) {
+        char* value = arg + 6;
+
+        if (strcmp(value, "uni") == 0) opts -> modalitaRicerca = BFS_UNIDIREZIONALE;
+        else if (strcmp(value, "bi") == 0) opts -> modalitaRicerca = BFS_BIDIREZIONALE;
+        else if (strcmp(value, "dir") == 0) opts -> modalitaRicerca = BFS_DIREZIONALE;
+        else if (strcmp(value, "astar") == 0) opts -> modalitaRicerca = BFS_ASTAR;
+        else return false;
+
+        return true;
+    }
+
+    if (strncmp(arg, "--snapshot=", 11) == 0) {
+        opts -> snapshot = arg + 11;
+        return *(opts -> snapshot) != '\0';
+    }
+
+    if (strncmp(arg, "--thread=", 9) == 0) return parsePositive(arg + 9, &opts -> numThread);
+
+    if (strncmp(arg, "--coda=", 7) == 0) return parsePositive(arg + 7, &opts -> dimensioneCoda);
+
+    if (strncmp(arg, "--cache-cammini=", 16) == 0) {
+        size_t megabytes;
+        if (!parseNonNegative(arg + 16, &megabytes) || megabytes > (SIZE_MAX >> 20)) return false; // Lo shift non deve traboccare
+
+        opts -> memoriaCacheCammini = megabytes << 20;
+        return true;
+    }
+
+    if (strncmp(arg, "--cache-alberi=", 15) == 0) return parseNonNegative(arg + 15, &opts -> numAlberi);
+
+    if (strncmp(arg, "--landmark=", 11) == 0) return parseNonNegative(arg + 11, &opts -> numLandmark) && opts -> numLandmark <= LANDMARK_MAX;
+
+    if (strncmp(arg, "--k-cammini=", 12) == 0) return parseNonNegative(arg + 12, &opts -> numCammini) && opts -> numCammini <= MAX_K_CAMMINI;
+
+    if (strncmp(arg, "--pipe=", 7) == 0) {
+        if (opts -> numPipe == MAX_PIPES || arg[7] == '\0') return false;
+
+        opts -> pipes[opts -> numPipe++] = arg + 7;
+        return true;
+    }
+
+    if (strncmp(arg, "--risposte=", 11) == 0) {
+        opts -> fileRisposte = arg + 11;
+        return *(opts -> fileRisposte) != '\0';
+    }
+
+    if (strncmp(arg, "--formato-risposte=", 19) == 0) {
+        char* value = arg + 19;
+
+        if (strcmp(value, "tsv") == 0) opts -> formatoRisposte = RISPOSTE_TSV;
+        else if (strcmp(value, "bin") == 0) opts -> formatoRisposte = RISPOSTE_BINARIO;
+        else return false;
+
+        return true;
+    }
+
+    if (strcmp(arg, "--analisi") == 0) {
+        opts -> analisi = true;
+        return true;
+    }
+
+    if (strcmp(arg, "--centralita") == 0) {
+        opts -> centralita = true;
+        return true;
+    }
+
+    if (strncmp(arg, "--campioni=", 11) == 0) return parseNonNegative(arg + 11, &opts -> numCampioni);
+
+    if (strncmp(arg, "--batch=", 8) == 0) {
+        opts -> fileBatch = arg + 8;
+        return *(opts -> fileBatch) != '\0';
+    }
+
+    return false;
+}
+
+/**
+ * @brief Stampa l'utilizzo del programma e le opzioni disponibili.
+ * @param program Nome dell'eseguibile (argv[0]).
+ */
+void printUsage(const char* program) {
+    printf("Errore: Utilizzo del programma invalido.\n");
+    printf("Uso: %s pathTo(nomi.txt) pathTo(grafo.txt) numConsumatori [opzioni]\n", program);
+    printf("     %s --snapshot=pathTo(snapshot) [opzioni]\n", program);
+    printf("Opzioni:\n");
+    printf("  --snapshot=FILE     Snapshot binario del grafo: se valido e aggiornato viene mappato in memoria,\n");
+    printf("                      altrimenti viene creato dopo la lettura dei file di testo\n");
+    printf("  --bfs=uni|bi|dir|astar\n");
+    printf("                      Algoritmo per i cammini minimi: BFS classica, bidirezionale, direction-optimizing\n");
+    printf("                      o A* guidata dai landmark, che richiede --landmark (default: bi)\n");
+    printf("  --thread=N          Numero di thread per il calcolo dei cammini minimi (default: numero di core)\n");
+    printf("  --coda=N            Capacità della coda delle richieste in attesa (default: %d)\n", DEFAULT_JOB_QUEUE_SIZE);
+    printf("  --cache-cammini=MB  Memoria massima della cache dei cammini minimi, 0 per disabilitarla (default: %d)\n", DEFAULT_PATH_CACHE_MB);
+    printf("  --cache-alberi=K    Memorizza l'albero BFS completo delle K sorgenti più richieste (default: 0, disabilitata)\n");
+    printf("  --landmark=K        Indice delle distanze da K landmark (al massimo %d), salvato accanto al grafo (default: 0)\n", LANDMARK_MAX);
+    printf("  --k-cammini=K       Conta i cammini minimi di ogni richiesta e ne scrive fino a K (al massimo %d),\n", MAX_K_CAMMINI);
+    printf("                      senza usare le cache (default: 0, un solo cammino)\n");
+    printf("  --pipe=FILE         Named pipe da cui leggere le richieste, ripetibile fino a %d volte (default: %s)\n", MAX_PIPES, DEFAULT_PIPE);
+    printf("  --risposte=FILE     Named pipe su cui scrivere le risposte invece dei file a.b, usati solo\n");
+    printf("                      se nessun lettore è connesso (default: disabilitata)\n");
+    printf("  --formato-risposte=tsv|bin\n");
+    printf("                      Formato dei record sulla pipe delle risposte (default: tsv)\n");
+    printf("  --batch=FILE        Risolve le coppie \"a b\" del file (una per linea) con BFS multi-sorgente e termina,\n");
+    printf("                      senza usare le named pipe\n");
+    printf("  --analisi           Calcola l'istogramma dei gradi di separazione e l'eccentricità di ogni nodo\n");
+    printf("                      (in %s e %s) e termina, senza usare le named pipe\n", ANALYSIS_HISTOGRAM_FILE, ANALYSIS_ECCENTRICITY_FILE);
+    printf("  --centralita        Calcola betweenness e closeness di ogni attore, scrive la classifica in %s e termina\n", CENTRALITY_FILE);
+    printf("  --campioni=N        Con --analisi e --centralita visita solo N sorgenti casuali invece di tutti i nodi,\n");
+    printf("                      per un risultato approssimato (default: 0, tutti)\n");
+}
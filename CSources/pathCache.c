@@ -0,0 +1,271 @@
+#define _GNU_SOURCE
+
+#include "../CHeaders/pathCache.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CACHE_MIN_BUCKETS 1024
+#define CACHE_BYTES_PER_BUCKET 256 // Size stimata di una voce, usata per dimensionare la tabella hash
+
+/**
+ * @brief Calcola la lista della tabella hash di una coppia di id densi.
+ * @param cache Puntatore alla cache.
+ * @param a Id denso minore.
+ * @param b Id denso maggiore.
+ * @return Indice della lista.
+ */
+static size_t bucketOf(pathCache* cache, int a, int b) {
+    uint64_t key = ((uint64_t)(uint32_t) a << 32) | (uint32_t) b;
+
+    // Finalizzatore di splitmix64
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+
+    return key & (cache -> numBuckets - 1);
+}
+
+/**
+ * @brief Byte occupati da una voce con un cammino di length nodi.
+ * @param length Numero di nodi del cammino.
+ * @return Size della voce.
+ */
+static size_t entrySize(size_t length) {
+    return sizeof(cacheEntry) + length * sizeof(int);
+}
+
+/**
+ * @brief Rimuove una voce dalla lista LRU.
+ * @param cache Puntatore alla cache.
+ * @param entry Voce da rimuovere.
+ */
+static void lruUnlink(pathCache* cache, cacheEntry* entry) {
+    if (entry -> newer) entry -> newer -> older = entry -> older;
+    else cache -> newest = entry -> older;
+
+    if (entry -> older) entry -> older -> newer = entry -> newer;
+    else cache -> oldest = entry -> newer;
+}
+
+/**
+ * @brief Inserisce una voce in testa alla lista LRU.
+ * @param cache Puntatore alla cache.
+ * @param entry Voce da inserire.
+ */
+static void lruPushFront(pathCache* cache, cacheEntry* entry) {
+    entry -> newer = NULL;
+    entry -> older = cache -> newest;
+
+    if (cache -> newest) cache -> newest -> newer = entry;
+    else cache -> oldest = entry;
+
+    cache -> newest = entry;
+}
+
+/**
+ * @brief Cerca una voce nella tabella hash.
+ * @param cache Puntatore alla cache.
+ * @param a Id denso minore.
+ * @param b Id denso maggiore.
+ * @return Puntatore alla voce, NULL se non presente.
+ */
+static cacheEntry* findEntry(pathCache* cache, int a, int b) {
+    for (cacheEntry* entry = cache -> buckets[bucketOf(cache, a, b)]; entry != NULL; entry = entry -> hashNext) {
+        if (entry -> a == a && entry -> b == b) return entry;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Elimina dalla cache la voce usata meno recentemente.
+ * @param cache Puntatore alla cache, non vuota.
+ */
+static void evictOldest(pathCache* cache) {
+    cacheEntry* victim = cache -> oldest;
+
+    // Rimozione dalla lista di trabocco
+    cacheEntry** link = &(cache -> buckets[bucketOf(cache, victim -> a, victim -> b)]);
+    while (*link != victim) link = &((*link) -> hashNext);
+    *link = victim -> hashNext;
+
+    lruUnlink(cache, victim);
+
+    cache -> memory -= entrySize(victim -> length);
+    cache -> entries--;
+    cache -> evictions++;
+
+    free(victim);
+}
+
+/**
+ * @brief Crea la cache dei cammini minimi.
+ * @param maxMemory Byte massimi occupati dalle voci, 0 per disabilitare la cache.
+ * @return Puntatore alla cache, NULL se disabilitata.
+ */
+pathCache* pathCacheCreate(size_t maxMemory) {
+    if (maxMemory == 0) return NULL;
+
+    pathCache* cache = malloc(sizeof(pathCache));
+    if (cache == NULL) xtermina(LINEFILE, "Allocazione della cache dei cammini fallita");
+
+    size_t numBuckets = CACHE_MIN_BUCKETS;
+    while (numBuckets < maxMemory / CACHE_BYTES_PER_BUCKET) numBuckets *= 2;
+
+    cache -> buckets = calloc(numBuckets, sizeof(cacheEntry*));
+    if (cache -> buckets == NULL) xtermina(LINEFILE, "Allocazione della tabella hash della cache dei cammini fallita");
+
+    cache -> numBuckets = numBuckets;
+    cache -> newest = NULL;
+    cache -> oldest = NULL;
+    cache -> memory = 0;
+    cache -> maxMemory = maxMemory;
+    cache -> entries = 0;
+    cache -> hits = 0;
+    cache -> misses = 0;
+    cache -> evictions = 0;
+
+    xpthread_mutex_init(&cache -> mutex, NULL, LINEFILE);
+
+    return cache;
+}
+
+/**
+ * @brief Cerca il cammino minimo tra due nodi, in entrambi i versi dato che il grafo non è orientato.
+ * @details Se la coppia è memorizzata come (b, a) il cammino viene copiato invertito. In caso di successo
+ *          la voce diventa la più recente della lista LRU.
+ * @param cache Puntatore alla cache, se NULL la ricerca fallisce sempre.
+ * @param a Id denso del nodo iniziale.
+ * @param b Id denso del nodo destinazione.
+ * @param path Array, di almeno numNodi elementi, in cui copiare il cammino da a a b.
+ * @param length Impostato al numero di nodi del cammino, 0 se il cammino non esiste.
+ * @return true se la coppia è presente nella cache, false altrimenti.
+ */
+bool pathCacheGet(pathCache* cache, int a, int b, int* path, size_t* length) {
+    if (!cache) return false;
+
+    bool swapped = a > b;
+    int low = swapped ? b : a;
+    int high = swapped ? a : b;
+
+    xpthread_mutex_lock(&cache -> mutex, LINEFILE);
+
+    cacheEntry* entry = findEntry(cache, low, high);
+
+    if (entry == NULL) {
+        cache -> misses++;
+        xpthread_mutex_unlock(&cache -> mutex, LINEFILE);
+        return false;
+    }
+
+    cache -> hits++;
+
+    lruUnlink(cache, entry);
+    lruPushFront(cache, entry);
+
+    *length = entry -> length;
+    if (!swapped) memcpy(path, entry -> nodes, entry -> length * sizeof(int));
+    else {
+        for (size_t i = 0; i < entry -> length; i++) path[i] = entry -> nodes[entry -> length - 1 - i];
+    }
+
+    xpthread_mutex_unlock(&cache -> mutex, LINEFILE);
+
+    return true;
+}
+
+/**
+ * @brief Memorizza il cammino minimo tra due nodi, eliminando le voci meno recenti oltre il limite di memoria.
+ * @details Anche l'assenza di un cammino (length 0) viene memorizzata. I cammini che da soli superano il limite
+ *          non vengono memorizzati.
+ * @param cache Puntatore alla cache, se NULL non fa nulla.
+ * @param a Id denso del nodo iniziale.
+ * @param b Id denso del nodo destinazione.
+ * @param path Cammino da a a b.
+ * @param length Numero di nodi del cammino, 0 se il cammino non esiste.
+ */
+void pathCachePut(pathCache* cache, int a, int b, const int* path, size_t length) {
+    if (!cache) return;
+
+    size_t size = entrySize(length);
+    if (size > cache -> maxMemory) return;
+
+    bool swapped = a > b;
+
+    cacheEntry* entry = malloc(size);
+    if (entry == NULL) xtermina(LINEFILE, "Allocazione di una voce della cache dei cammini fallita");
+
+    entry -> a = swapped ? b : a;
+    entry -> b = swapped ? a : b;
+    entry -> length = length;
+
+    // Memorizza sempre il cammino dal nodo minore al maggiore
+    if (!swapped) memcpy(entry -> nodes, path, length * sizeof(int));
+    else {
+        for (size_t i = 0; i < length; i++) entry -> nodes[i] = path[length - 1 - i];
+    }
+
+    xpthread_mutex_lock(&cache -> mutex, LINEFILE);
+
+    // Un altro worker potrebbe aver calcolato la stessa coppia nel frattempo
+    if (findEntry(cache, entry -> a, entry -> b) != NULL) {
+        xpthread_mutex_unlock(&cache -> mutex, LINEFILE);
+        free(entry);
+        return;
+    }
+
+    while (cache -> memory + size > cache -> maxMemory) evictOldest(cache);
+
+    size_t bucket = bucketOf(cache, entry -> a, entry -> b);
+    entry -> hashNext = cache -> buckets[bucket];
+    cache -> buckets[bucket] = entry;
+
+    lruPushFront(cache, entry);
+
+    cache -> memory += size;
+    cache -> entries++;
+
+    xpthread_mutex_unlock(&cache -> mutex, LINEFILE);
+}
+
+/**
+ * @brief Stampa su stderr i contatori della cache.
+ * @param cache Puntatore alla cache, se NULL non fa nulla.
+ */
+void pathCachePrintStats(pathCache* cache) {
+    if (!cache) return;
+
+    xpthread_mutex_lock(&cache -> mutex, LINEFILE);
+
+    size_t requests = cache -> hits + cache -> misses;
+    double hitRate = requests > 0 ? 100.0 * cache -> hits / requests : 0.0;
+
+    fprintf(stderr, "Cache dei cammini: %zu hit, %zu miss (%.1f%%), %zu voci, %zu eliminate, %zu/%zu byte.\n",
+            cache -> hits, cache -> misses, hitRate, cache -> entries, cache -> evictions, cache -> memory, cache -> maxMemory);
+
+    xpthread_mutex_unlock(&cache -> mutex, LINEFILE);
+}
+
+/**
+ * @brief Dealloca la cache e tutte le sue voci.
+ * @param cache Puntatore alla cache.
+ */
+void pathCacheFree(pathCache* cache) {
+    if (!cache) return;
+
+    while (cache -> oldest != NULL) {
+        cacheEntry* entry = cache -> oldest;
+        cache -> oldest = entry -> newer;
+        free(entry);
+    }
+
+    xpthread_mutex_destroy(&cache -> mutex, LINEFILE);
+    free(cache -> buckets);
+    free(cache);
+}
@@ -0,0 +1,236 @@
+#define _GNU_SOURCE
+
+#include "../CHeaders/responses.h"
+#include "../CHeaders/shortestPaths.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+/**
+ * @brief Crea il canale delle risposte, la pipe viene aperta solo quando c'è una risposta da inviare.
+ * @param path Percorso della named pipe delle risposte, già creata.
+ * @param formato Formato dei record.
+ * @return Puntatore al canale.
+ */
+responseChannel* responseChannelCreate(const char* path, formatoRisposte formato) {
+    responseChannel* channel = malloc(sizeof(responseChannel));
+    if (channel == NULL) xtermina(LINEFILE, "Allocazione del canale delle risposte fallita");
+
+    channel -> path = path;
+    channel -> formato = formato;
+    channel -> fd = -1;
+    channel -> inviate = 0;
+    channel -> suFile = 0;
+    xpthread_mutex_init(&channel -> mutex, NULL, LINEFILE);
+
+    return channel;
+}
+
+/**
+ * @brief Scrive un record completo sulla pipe delle risposte, aprendola se un lettore si è connesso.
+ * @details L'apertura non bloccante fallisce con ENXIO se nessun lettore ha aperto la pipe, in quel caso la risposta
+ *          va scritta nel file a.b. Una volta aperta la pipe torna bloccante, così un lettore lento rallenta i worker
+ *          invece di perdere risposte. Se il lettore chiude la pipe (EPIPE) il descrittore viene chiuso e riaperto
+ *          alla prossima risposta. Il record viene scritto sotto mutex, senza mescolarsi a quelli degli altri worker.
+ * @param channel Canale delle risposte.
+ * @param record Byte del record.
+ * @param size Numero di byte del record.
+ * @return true se il record è stato scritto sulla pipe, false se va scritto nel file a.b.
+ */
+static bool sendRecord(responseChannel* channel, const char* record, size_t size) {
+    xpthread_mutex_lock(&channel -> mutex, LINEFILE);
+
+    if (channel -> fd < 0) {
+        channel -> fd = open(channel -> path, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+
+        if (channel -> fd >= 0) {
+            int flags = fcntl(channel -> fd, F_GETFL);
+            if (flags == -1 || fcntl(channel -> fd, F_SETFL, flags & ~O_NONBLOCK) == -1) xtermina(LINEFILE, "fcntl sulla pipe delle risposte fallita");
+            fprintf(stderr, "Lettore connesso a %s.\n", channel -> path);
+        }
+        else if (errno != ENXIO) xtermina(LINEFILE, "Apertura della pipe delle risposte %s fallita", channel -> path);
+    }
+
+    bool sent = false;
+
+    if (channel -> fd >= 0) {
+        size_t written = 0;
+
+        while (written < size) {
+            ssize_t e = write(channel -> fd, record + written, size - written);
+
+            if (e >= 0) written += e;
+            else if (errno == EINTR) continue;
+            else if (errno == EPIPE) break; // SIGPIPE è ignorato, il lettore ha chiuso la pipe
+            else xtermina(LINEFILE, "Scrittura sulla pipe delle risposte %s fallita", channel -> path);
+        }
+
+        sent = written == size;
+
+        if (!sent) {
+            fprintf(stderr, "Lettore di %s disconnesso.\n", channel -> path);
+            close(channel -> fd);
+            channel -> fd = -1;
+        }
+    }
+
+    if (sent) channel -> inviate++;
+    else channel -> suFile++;
+
+    xpthread_mutex_unlock(&channel -> mutex, LINEFILE);
+
+    return sent;
+}
+
+/**
+ * @brief Formatta in fondo al buffer la linea tsv della risposta con un cammino, o senza cammino.
+ * @param buffer Buffer in fondo al quale scrivere.
+ * @param g Grafo degli attori.
+ * @param a Codice dell'attore iniziale.
+ * @param b Codice dell'attore destinazione.
+ * @param lunghezza Numero di archi del cammino o RESPONSE_NO_PATH.
+ * @param path Id densi dei nodi del cammino.
+ * @param length Numero di nodi del cammino, 0 se il cammino non esiste.
+ */
+static void formatTsvPath(textBuffer* buffer, grafo* g, int32_t a, int32_t b, int32_t lunghezza, const int* path, size_t length) {
+    textBufferAppendInt(buffer, a);
+    textBufferAppend(buffer, "\t", 1);
+    textBufferAppendInt(buffer, b);
+    textBufferAppend(buffer, "\t", 1);
+    textBufferAppendInt(buffer, lunghezza);
+
+    for (size_t i = 0; i < length; i++) {
+        textBufferAppend(buffer, "\t", 1);
+        textBufferAppendInt(buffer, g -> codici[path[i]]);
+        textBufferAppend(buffer, "\t", 1);
+        textBufferAppendString(buffer, nodeName(g, path[i]));
+        textBufferAppend(buffer, "\t", 1);
+        textBufferAppendInt(buffer, g -> anni[path[i]]);
+    }
+
+    textBufferAppend(buffer, "\n", 1);
+}
+
+/**
+ * @brief Invia sulla pipe delle risposte il cammino minimo di una richiesta.
+ * @param channel Canale delle risposte.
+ * @param g Grafo degli attori.
+ * @param buffer Buffer di testo del thread chiamante, in cui viene preparato il record.
+ * @param a Codice dell'attore iniziale.
+ * @param b Codice dell'attore destinazione.
+ * @param path Id densi dei nodi del cammino.
+ * @param length Numero di nodi del cammino, 0 se il cammino non esiste.
+ * @return true se la risposta è stata inviata, false se va scritta nel file a.b.
+ */
+bool responseSendPath(responseChannel* channel, grafo* g, textBuffer* buffer, int32_t a, int32_t b, const int* path, size_t length) {
+    int32_t lunghezza = length > 0 ? (int32_t) length - 1 : RESPONSE_NO_PATH;
+    textBufferClear(buffer);
+
+    if (channel -> formato == RISPOSTE_BINARIO) {
+        // Spazio per l'header, riempito quando è nota la dimensione del testo
+        textBufferReserve(buffer, sizeof(responseHeader));
+        buffer -> size = sizeof(responseHeader);
+
+        if (length == 0) formatNoPath(buffer, a, b);
+        else formatPath(g, path, length, buffer);
+
+        responseHeader header = { .a = a, .b = b, .lunghezza = lunghezza, .dimensione = buffer -> size - sizeof(responseHeader) };
+        memcpy(buffer -> data, &header, sizeof(header));
+    }
+    else {
+        formatTsvPath(buffer, g, a, b, lunghezza, path, length);
+    }
+
+    return sendRecord(channel, buffer -> data, buffer -> size);
+}
+
+/**
+ * @brief Invia sulla pipe delle risposte i cammini minimi enumerati di una richiesta, con un'unica scrittura.
+ * @details In formato binario il record contiene lo stesso testo del file a.b, con il numero di archi dei cammini
+ *          come lunghezza; in formato tsv viene scritta una linea per cammino, ognuna un record completo.
+ * @param channel Canale delle risposte.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto dell'ultima bfsCountPaths() andata a buon fine, il cui buffer di output viene usato per il record.
+ * @param e Enumeratore dei cammini, non ancora usato.
+ * @param a Codice dell'attore iniziale.
+ * @param b Codice dell'attore destinazione.
+ * @param maxPaths Numero massimo di cammini da inviare.
+ * @return true se la risposta è stata inviata, false se va scritta nel file a.b.
+ */
+bool responseSendPaths(responseChannel* channel, grafo* g, bfsContext* ctx, pathEnumerator* e, int32_t a, int32_t b, size_t maxPaths) {
+    textBuffer* buffer = ctx -> output;
+    textBufferClear(buffer);
+
+    if (channel -> formato == RISPOSTE_BINARIO) {
+        textBufferReserve(buffer, sizeof(responseHeader));
+        buffer -> size = sizeof(responseHeader);
+
+        formatPaths(g, ctx, e, maxPaths, buffer);
+
+        responseHeader header = { .a = a, .b = b, .lunghezza = e -> distanza, .dimensione = buffer -> size - sizeof(responseHeader) };
+        memcpy(buffer -> data, &header, sizeof(header));
+    }
+    else {
+        size_t length;
+
+        for (size_t k = 0; k < maxPaths && (length = bfsNextPath(g, ctx, e)) > 0; k++) {
+            formatTsvPath(buffer, g, a, b, length - 1, ctx -> path, length);
+        }
+    }
+
+    return sendRecord(channel, buffer -> data, buffer -> size);
+}
+
+/**
+ * @brief Invia sulla pipe delle risposte la risposta ad una richiesta con un codice non presente nel grafo.
+ * @param channel Canale delle risposte.
+ * @param buffer Buffer di testo del thread chiamante, in cui viene preparato il record.
+ * @param a Codice dell'attore iniziale.
+ * @param b Codice dell'attore destinazione.
+ * @param invalid Codice non valido tra a e b.
+ * @return true se la risposta è stata inviata, false se va scritta nel file a.b.
+ */
+bool responseSendInvalid(responseChannel* channel, textBuffer* buffer, int32_t a, int32_t b, int32_t invalid) {
+    textBufferClear(buffer);
+
+    if (channel -> formato == RISPOSTE_BINARIO) {
+        textBufferReserve(buffer, sizeof(responseHeader));
+        buffer -> size = sizeof(responseHeader);
+
+        formatInvalid(buffer, invalid);
+
+        responseHeader header = { .a = a, .b = b, .lunghezza = RESPONSE_INVALID, .dimensione = buffer -> size - sizeof(responseHeader) };
+        memcpy(buffer -> data, &header, sizeof(header));
+    }
+    else {
+        textBufferAppendInt(buffer, a);
+        textBufferAppend(buffer, "\t", 1);
+        textBufferAppendInt(buffer, b);
+        textBufferAppend(buffer, "\t", 1);
+        textBufferAppendInt(buffer, RESPONSE_INVALID);
+        textBufferAppend(buffer, "\t", 1);
+        textBufferAppendInt(buffer, invalid);
+        textBufferAppend(buffer, "\n", 1);
+    }
+
+    return sendRecord(channel, buffer -> data, buffer -> size);
+}
+
+/**
+ * @brief Stampa le statistiche del canale delle risposte, chiude la pipe e dealloca il canale.
+ * @param channel Puntatore al canale.
+ */
+void responseChannelFree(responseChannel* channel) {
+    if (!channel) return;
+
+    fprintf(stderr, "Risposte: %zu inviate su %s, %zu scritte nei file a.b senza lettore connesso.\n", channel -> inviate, channel -> path, channel -> suFile);
+
+    if (channel -> fd >= 0) close(channel -> fd);
+    xpthread_mutex_destroy(&channel -> mutex, LINEFILE);
+    free(channel);
+}
@@ -1,299 +1,583 @@
-#define _GNU_SOURCE
-
-#include "../CHeaders/shortestPaths.h"
-#include "../CHeaders/utilities.h"
-#include "../CHeaders/dataStructures.h"
-#include "../CHeaders/actors.h"
-#include "../CHeaders/xerrori.h"
-
-#include <fcntl.h> // Per O_RDONLY
-#include <inttypes.h> // Per PRId32
-#include <sys/select.h> // Per select()
-#include <unistd.h>
-#include <errno.h>
-#include <pthread.h>
-#include <stdlib.h>
-#include <sys/times.h>
-
-/**
- * @brief Legge i messaggi dalla pipe e crea i thread per il calcolo dei cammini minimi.
- * @param attori Array dei nodi attore creato in createActors().
- * @param mustShutdown Booleano per gestire l'arrivo di SIGINT.
- */
-void pipeReader(size_t n, attore** attori, volatile bool* mustShutdown) {    
-    // Apre la pipe in lettura
-    int fd;
-
-    /*
-        Il ciclo è usato per lo stesso motivo della select() durante la lettura,
-        se arrivasse SIGINT prima che un lettore apra la pipe, non verrebbe gestita
-        correttamente dato che il programma sarebbe in attesa passiva.
-    */
-
-    while (true) {
-        if (*mustShutdown) {
-            fprintf(stderr, "Inizio attesa di 20 secondi.\n");
-            sleep(20);
-            fprintf(stderr, "Fine attesa di 20 secondi.\n");
-            return; // Esce direttamente, non deve deallocare o chiudere file
-        }
-
-        fd = open("cammini.pipe", O_RDONLY | O_NONBLOCK);
-        if (fd >= 0) break; // Pipe aperta da uno scrittore
-        else if (errno == ENXIO) { // Pipe ancora non aperta in scrittura
-            sleep(1);
-            continue;
-        }
-        else xtermina(LINEFILE, "Apertura della pipe fallita");
-    }
-
-    message msg;
-    ssize_t readVal;
-
-    fprintf(stderr, "Inizio lettura dalla pipe.\n");
-
-    // Legge dalla pipe
-    while (!(*mustShutdown)) {
-        /*
-            Usato select + timeout dato che non è possibile rendere la pipe non bloccante
-            (perché non posso modificare cammini.py per aggiungere i dovuti check sulla write),
-            è necessario perché in un eventuale caso in cui il programma resta in attesa
-            sulla pipe, potrebbe non notare il cambiamento di mustShutdown (arrivo di SIGINT)
-            e quindi non funzionare come descritto dal professore.
-
-            select() è una chiamata di sistema che permette ad un processo di, in questo caso,
-            attendere che il file descriptor della pipe sia pronto per la lettura, evitando
-            blocchi di attesa indefinita.
-            
-            Parametri:
-                nfds: Valore più alto dei file descriptors monitorati + 1 (fd + 1 in questo caso)
-                readfds: puntatore ad un fd_set con i file descriptors da monitorare in lettura (readfds)
-                writefds: analogo di readfds ma per scrittura (NULL)
-                exceptfds: analogo di readfds ma per errori eccezionali (NULL)
-                timeout: tempo speso a monitorare i file descriptor prima di uscire (500ms)
-
-            Funzioni:
-                FD_ZERO: Inizializza un fd_set vuoto
-                FD_SET: Aggiunge un file descriptor ad un fd_set
-        */
-
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        FD_SET(fd, &readfds);
-
-        struct timeval timeout;
-        timeout.tv_sec = 0;
-        timeout.tv_usec = 500000; // 500ms
-
-        int retval = select(fd + 1, &readfds, NULL, NULL, &timeout);
-
-        if (retval == -1) xtermina(LINEFILE, "select fallita durante check sulla pipe"); 
-        else if (retval == 0) continue; // Timeout terminato
-        else { // Pipe pronta in lettura
-            readVal = read(fd, &msg, sizeof(msg));
-
-            if (readVal < 0) xtermina(LINEFILE, "Lettura dalla pipe fallita");
-            else if (readVal == 0) break;
-            else if (readVal < sizeof(msg)) xtermina(LINEFILE, "Letto un messaggio incompleto dalla pipe");
-
-            fprintf(stderr, "Creazione thread per codici: %" PRId32 " e %" PRId32 ".\n", msg.a, msg.b);
-            createShortestPathThread(msg.a, msg.b, attori, n);
-        }
-    }
-
-    fprintf(stderr, "Inizio attesa di 20 secondi.\n");
-    sleep(20);
-    fprintf(stderr, "Fine attesa di 20 secondi.\n");
-
-    close(fd);
-}
-
-/**
- * @brief Crea un thread detached calcolatore di cammini minimi. 
- * @param a Intero a 32 bit rappresentante il codice del primo attore.
- * @param b Intero a 32 bit rappresentante il codice del secondo attore.
- * @param attori Array dei nodi attore. (Grafo)
- */
-void createShortestPathThread(int32_t a, int32_t b, attore** attori, size_t n) {
-    pthread_t thread;
-    pathThreadData* data = malloc(sizeof(pathThreadData));
-    if (data == NULL) xtermina(LINEFILE, "Allocazione della struct per thread calcolatore di cammini minimi fallita");
-
-    data -> a = a;
-    data -> b = b;
-    data -> actors = attori;
-    data -> size = n;
-
-    xpthread_create(&thread, NULL, &pathThreadBody, data, LINEFILE);
-    if (pthread_detach(thread) != 0) xtermina(LINEFILE, "pthread_detach del thread calcolatore di cammini fallita");
-}
-
-/**
- * @brief Funzione eseguita dal thread calcolatore di cammini.
- * @param arg Struttura passata da createShortestPathThread().
- */
-void* pathThreadBody(void* arg) {
-    clock_t timeStart = times(NULL);
-    pathThreadData* data = (pathThreadData*) arg;
-
-    fprintf(stderr, "Inizio thread per %" PRId32 " e %" PRId32 ".\n", data -> a, data -> b);
-
-    // Crea il file
-    char filename[50]; // Abbondante per evitare overflow
-    sprintf(filename, "%" PRId32 ".%" PRId32, data -> a, data -> b);
-
-    FILE* file = xfopen(filename, "w", LINEFILE);
-
-    // Ricerca binaria per trovare a
-    attore* actorA = *(attore**) bsearch(&(data -> a), data -> actors, data -> size, sizeof(attore*), &compareAttore);
-
-    if (actorA == NULL) {
-        fprintf(file, "Codice %" PRId32 " non valido\n", data -> a);
-        fclose(file);
-        printf("%" PRId32 ".%" PRId32 ": Codici invalidi. Tempo di elaborazione %.3f secondi", data -> a, data -> b, (double)(times(NULL) - timeStart) / sysconf(_SC_CLK_TCK));
-        free(data);
-        pthread_exit(NULL);
-    }
-
-    if (data -> a == data -> b) {
-        char* actorString = actorToString(actorA);
-
-        fprintf(file, "%s\n", actorString);
-
-        free(actorString);
-        fclose(file);
-        printf("%" PRId32 ".%" PRId32 ": Lunghezza minima 0. Tempo di elaborazione %.3f secondi", data -> a, data -> b, (double)(times(NULL) - timeStart) / sysconf(_SC_CLK_TCK));
-        pthread_exit(NULL);
-    }
-
-    // Ricerca binaria per trovare b
-    attore* actorB = *(attore**) bsearch(&(data -> b), data -> actors, data -> size, sizeof(attore*), &compareAttore);
-
-    if (actorB == NULL) {
-        fprintf(file, "Codice %" PRId32 " non valido\n", data -> b);
-        fclose(file);
-        printf("%" PRId32 ".%" PRId32 ": Codici invalidi. Tempo di elaborazione %.3f secondi", data -> a, data -> b, (double)(times(NULL) - timeStart) / sysconf(_SC_CLK_TCK));
-        free(data);
-        pthread_exit(NULL);
-    }
-
-    // Crea abr e aggiunge a
-    abr* explored = malloc(sizeof(abr));
-    if (explored == NULL) xtermina(LINEFILE, "Allocazione dell'abr fallita");
-
-    explored -> shuffledCode = shuffle(actorA -> codice);
-    explored -> left = NULL;
-    explored -> right = NULL;
-
-    // Crea coda di ricerca e aggiunge a senza genitore
-    circularQueue* queue = queueCreate();
-    enqueue(queue, actorA -> codice);
-
-    // Crea array usato per open addressing sui genitori nella ricerca del cammino minimo
-    int* parents = calloc((data -> actors)[data -> size - 1] -> codice, sizeof(int));
-    if (parents == NULL) xtermina(LINEFILE, "Allocazione array dei genitori per open addressing fallita");
-
-    // Aggiunge -1 come padre di a
-    parents[actorA -> codice] = -1;
-    
-    bool found = false;
-    int currentCode;
-
-    // BFS
-    while (!queueIsEmpty(queue)) {
-        currentCode = dequeue(queue);
-        attore* currentActor = *(attore**) bsearch(&currentCode, data -> actors, data -> size, sizeof(attore*), &compareAttore);
-
-        // Scorre i coprotagonisti
-        for (size_t i = 0; i < currentActor -> numcop; i++) {
-            int coprotCode = (currentActor -> cop)[i];
-            
-            // Se trova B, setta il genitore ed esce
-            if (coprotCode == actorB -> codice) {
-                parents[coprotCode] = currentCode;
-                found = true;
-                break;
-            }
-
-            // Se attore già esplorato salta
-            if (abrContains(explored, shuffle(coprotCode))) continue;
-
-            // Se attore non esplorato lo aggiunge all'ABR, alla coda e setta il parent
-            abrAdd(explored, shuffle(coprotCode));
-            enqueue(queue, coprotCode);
-            parents[coprotCode] = currentCode;
-
-        }
-
-        if (found) break;
-    }
-
-    if (!found) {
-        fprintf(file, "Non esistono cammini da %d a %d\n", actorA -> codice, actorB -> codice);
-        printf("%" PRId32 ".%" PRId32 ": Lunghezza minima 0. Tempo di elaborazione %.3f secondi", data -> a, data -> b, (double)(times(NULL) - timeStart) / sysconf(_SC_CLK_TCK));
-        fclose(file);
-        abrFree(explored);
-        free(data);
-        freeQueue(queue);
-        pthread_exit(NULL);
-    }
-
-    clock_t timeEnd = times(NULL);
-    double elapsed_time = (double)(timeEnd - timeStart) / sysconf(_SC_CLK_TCK);
-
-    fprintf(stderr, "Inizio scrittura su %" PRId32 ".%" PRId32 ".\n", data -> a, data -> b);
-    size_t len = printShortestPath(actorB, file, parents, data -> actors, data -> size);
-    fprintf(stderr, "Termine scrittura su %" PRId32 ".%" PRId32 ".\n", data -> a, data -> b);
-
-    printf("%" PRId32 ".%" PRId32 ": Lunghezza minima %ld. Tempo di elaborazione %.3f secondi.\n", data -> a, data -> b, len, elapsed_time);
-
-    fprintf(stderr, "Termine thread per %" PRId32 " e %" PRId32 ".\n", data -> a, data -> b);
-
-    // Clean-up
-    fclose(file);
-    freeQueue(queue);
-    abrFree(explored);
-    free(data);
-    free(parents);
-
-    pthread_exit(NULL);
-}
-
-/**
- * @brief Stampa sul file gli attori appartenenti al cammino minimo da start a target.
- * @param target Attore target del cammino.
- * @param tree ABR costruito dal thread calcolatore di cammini minimi.
- * @param file File su cui scrivere il cammino.
- * @return Lunghezza del cammino calcolato.
- */
-size_t printShortestPath(attore* target, FILE* file, int* parents, attore** attori, size_t n) {
-    attore* currentActor = target;
-    int currentCode = currentActor -> codice;
-    stack* stack = stackCreate();
-
-    // Popola lo stack
-    while (true) {
-        stackPush(stack, currentActor);
-        if (parents[currentCode] == -1) break;
-
-        currentActor = *(attore**) bsearch(&parents[currentCode], attori, n, sizeof(attore*), &compareAttore);
-        currentCode = currentActor -> codice;
-    }
-
-    size_t len = 0; // Lunghezza del cammino
-    char* actorString;
-
-    // Stampa in ordine
-    while (!stackIsEmpty(stack)) {
-        len++;
-        target = stackPop(stack);
-        actorString = actorToString(target);
-        fprintf(file, "%s\n", actorString);
-        free(actorString);
-    }
-
-    // Clean-up
-    stackFree(stack);
-
-    return len - 1;
-}
+#define _GNU_SOURCE
+
+#include "../CHeaders/shortestPaths.h"
+#include "../CHeaders/utilities.h"
+#include "../CHeaders/dataStructures.h"
+#include "../CHeaders/bfs.h"
+#include "../CHeaders/actors.h"
+#include "../CHeaders/xerrori.h"
+
+#include <fcntl.h> // Per O_RDONLY
+#include <inttypes.h> // Per PRId32
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/times.h>
+
+/**
+ * @brief Apre una named pipe in lettura non bloccante e la registra in epoll.
+ * @details L'apertura in lettura non bloccante non attende uno scrittore, epoll segnala la pipe solo quando
+ *          uno scrittore la apre e scrive.
+ * @param epfd File descriptor dell'istanza epoll.
+ * @param path Percorso della named pipe.
+ * @param index Indice della pipe, restituito da epoll insieme ai suoi eventi.
+ * @return File descriptor della pipe.
+ */
+static int armPipe(int epfd, const char* path, uint32_t index) {
+    int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) xtermina(LINEFILE, "Apertura della pipe %s fallita", path);
+
+    struct epoll_event event = { .events = EPOLLIN, .data.u32 = index };
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event) == -1) xtermina(LINEFILE, "Registrazione della pipe %s in epoll fallita", path);
+
+    return fd;
+}
+
+/**
+ * @brief Interpreta un frame completo del protocollo delle pipe.
+ * @details I frame di una versione diversa, con un opcode sconosciuto o con un payload troppo corto vengono scartati
+ *          con un messaggio, senza interrompere la lettura: la lunghezza nell'header permette sempre di passare al record
+ *          successivo. I byte di payload oltre quelli previsti dall'opcode vengono ignorati, così le versioni future
+ *          possono aggiungere campi in fondo.
+ * @param src Pipe da cui è stato letto il frame.
+ * @param header Header del frame.
+ * @param payload Payload del frame, header -> lunghezza byte.
+ * @param job Lavoro da riempire se il frame è una richiesta.
+ * @return true se job è stato riempito, false se il frame è stato scartato.
+ */
+static bool parseFrame(const pipeSource* src, const frameHeader* header, const char* payload, pathJob* job) {
+    if (header -> versione != FRAME_VERSION) {
+        fprintf(stderr, "Scartato il frame %" PRIu32 " da %s: versione %" PRIu16 " non supportata.\n", header -> idRichiesta, src -> path, header -> versione);
+        return false;
+    }
+
+    switch (header -> opcode) {
+        case OP_CAMMINO: {
+            if (header -> lunghezza < sizeof(message)) break;
+
+            message msg;
+            memcpy(&msg, payload, sizeof(msg));
+            *job = (pathJob) { .a = msg.a, .b = msg.b, .idRichiesta = header -> idRichiesta };
+            return true;
+        }
+
+        case OP_CAMMINO_VINCOLATO: {
+            if (header -> lunghezza < sizeof(constrainedPayload)) break;
+
+            constrainedPayload request;
+            memcpy(&request, payload, sizeof(request));
+            *job = (pathJob) { .a = request.a, .b = request.b, .idRichiesta = header -> idRichiesta, .vincolato = true,
+                               .vincolo = { .annoMin = request.annoMin, .annoMax = request.annoMax } };
+            return true;
+        }
+
+        default:
+            fprintf(stderr, "Scartato il frame %" PRIu32 " da %s: opcode %" PRIu16 " sconosciuto.\n", header -> idRichiesta, src -> path, header -> opcode);
+            return false;
+    }
+
+    fprintf(stderr, "Scartato il frame %" PRIu32 " da %s: payload di %" PRIu16 " byte troppo corto per l'opcode %" PRIu16 ".\n",
+            header -> idRichiesta, src -> path, header -> lunghezza, header -> opcode);
+    return false;
+}
+
+/**
+ * @brief Legge con una sola read() i messaggi disponibili su una pipe e li passa in blocco al pool di thread.
+ * @details Il blocco letto viene diviso in record completi, frame o messaggi legacy riconosciuti dal primo intero,
+ *          e i byte di un eventuale record troncato alla fine vengono conservati nella sorgente e premessi al blocco
+ *          successivo. Ogni record occupa almeno 8 byte, quindi i lavori di un blocco sono al più PIPE_READ_BUFFER / 8.
+ *          Se restano dati da leggere epoll segnala di nuovo la pipe, così una pipe molto attiva non blocca le altre.
+ * @param pool Pool di thread calcolatori di cammini minimi.
+ * @param src Pipe da leggere, con il suo messaggio incompleto.
+ * @param buffer Buffer di lettura di PIPE_READ_BUFFER byte.
+ * @param jobs Array di PIPE_READ_BUFFER / sizeof(message) lavori.
+ * @return true se tutti gli scrittori hanno chiuso la pipe (EOF), false altrimenti.
+ */
+static bool drainPipe(threadPool* pool, pipeSource* src, char* buffer, pathJob* jobs) {
+    memcpy(buffer, src -> resto, src -> dimensioneResto);
+
+    ssize_t readVal;
+    do readVal = read(src -> fd, buffer + src -> dimensioneResto, PIPE_READ_BUFFER - src -> dimensioneResto);
+    while (readVal < 0 && errno == EINTR);
+
+    if (readVal < 0) {
+        if (errno == EAGAIN) return false; // Nessun messaggio per ora
+        xtermina(LINEFILE, "Lettura dalla pipe %s fallita", src -> path);
+    }
+
+    if (readVal == 0) {
+        if (src -> dimensioneResto > 0) fprintf(stderr, "Scartati %zu byte di un messaggio incompleto da %s.\n", src -> dimensioneResto, src -> path);
+        if (src -> vincolato) fprintf(stderr, "Scartato un vincolo senza richiesta da %s.\n", src -> path);
+
+        src -> dimensioneResto = 0;
+        src -> daScartare = 0;
+        src -> vincolato = false;
+        return true;
+    }
+
+    size_t total = src -> dimensioneResto + readVal;
+    size_t pos = 0, numJobs = 0;
+
+    // Resto del payload di un frame troppo lungo letto nei blocchi precedenti
+    size_t skip = src -> daScartare < total ? src -> daScartare : total;
+    pos += skip;
+    src -> daScartare -= skip;
+
+    while (total - pos >= sizeof(uint32_t)) {
+        const char* record = buffer + pos;
+        size_t available = total - pos;
+
+        uint32_t magic;
+        memcpy(&magic, record, sizeof(magic));
+
+        if (magic != FRAME_MAGIC) {
+            // Messaggio legacy da 8 byte
+            if (available < sizeof(message)) break;
+
+            message msg;
+            memcpy(&msg, record, sizeof(message));
+            pos += sizeof(message);
+
+            // Record di vincolo: viene ricordato per la pipe, anche a cavallo tra due blocchi, e applicato alla richiesta successiva
+            if (msg.a == MESSAGE_CONSTRAINT) {
+                constraintRecord constraint;
+                memcpy(&constraint, &msg, sizeof(constraint));
+
+                src -> vincolato = true;
+                src -> vincolo = (yearFilter) { .annoMin = constraint.annoMin, .annoMax = constraint.annoMax };
+                continue;
+            }
+
+            jobs[numJobs++] = (pathJob) { .a = msg.a, .b = msg.b, .vincolato = src -> vincolato, .vincolo = src -> vincolo };
+            src -> vincolato = false;
+            continue;
+        }
+
+        if (available < sizeof(frameHeader)) break;
+
+        frameHeader header;
+        memcpy(&header, record, sizeof(header));
+
+        if (header.lunghezza > FRAME_MAX_PAYLOAD) {
+            // Il frame non entra nel resto: il payload viene scartato man mano che arriva
+            fprintf(stderr, "Scartato il frame %" PRIu32 " da %s: payload di %" PRIu16 " byte oltre il massimo di %d.\n", header.idRichiesta, src -> path, header.lunghezza, FRAME_MAX_PAYLOAD);
+
+            size_t present = available - sizeof(frameHeader) < header.lunghezza ? available - sizeof(frameHeader) : header.lunghezza;
+            pos += sizeof(frameHeader) + present;
+            src -> daScartare = header.lunghezza - present;
+            continue;
+        }
+
+        if (available < sizeof(frameHeader) + header.lunghezza) break;
+
+        if (parseFrame(src, &header, record + sizeof(frameHeader), &jobs[numJobs])) numJobs++;
+        pos += sizeof(frameHeader) + header.lunghezza;
+    }
+
+    // Record troncato alla fine del blocco, completato dalla prossima lettura
+    src -> dimensioneResto = total - pos;
+    memcpy(src -> resto, buffer + pos, src -> dimensioneResto);
+
+    if (numJobs > 0) {
+        fprintf(stderr, "Lette %zu richieste da %s.\n", numJobs, src -> path);
+        poolSubmitBatch(pool, jobs, numJobs);
+    }
+
+    return false;
+}
+
+/**
+ * @brief Server delle richieste: legge i messaggi da tutte le named pipe e li passa al pool di thread.
+ * @details Le pipe e l'eventfd di terminazione sono registrati nella stessa istanza epoll, il thread resta in attesa
+ *          passiva finché una pipe ha dati o arriva SIGINT, senza timeout. Quando gli scrittori di una pipe la chiudono
+ *          la pipe viene riaperta, pronta per i prossimi scrittori. All'arrivo di SIGINT attende 20 secondi e termina.
+ * @param pool Pool di thread calcolatori di cammini minimi.
+ * @param opts Opzioni passate da linea di comando, con le named pipe da servire.
+ * @param shutdownFd eventfd su cui il thread gestore dei segnali scrive all'arrivo di SIGINT.
+ */
+void pipeReader(threadPool* pool, const opzioni* opts, int shutdownFd) {
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd == -1) xtermina(LINEFILE, "Creazione dell'istanza epoll fallita");
+
+    // L'eventfd ha come indice MAX_PIPES, le pipe il loro indice in opts -> pipes
+    struct epoll_event shutdownEvent = { .events = EPOLLIN, .data.u32 = MAX_PIPES };
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, shutdownFd, &shutdownEvent) == -1) xtermina(LINEFILE, "Registrazione dell'eventfd in epoll fallita");
+
+    pipeSource sources[MAX_PIPES];
+
+    for (size_t i = 0; i < opts -> numPipe; i++) {
+        sources[i].path = opts -> pipes[i];
+        sources[i].fd = armPipe(epfd, sources[i].path, i);
+        sources[i].dimensioneResto = 0;
+        sources[i].daScartare = 0;
+        sources[i].vincolato = false;
+    }
+
+    // Buffer di lettura e lavori di un blocco, condivisi da tutte le pipe
+    char* buffer = malloc(PIPE_READ_BUFFER);
+    pathJob* jobs = malloc(PIPE_READ_BUFFER / sizeof(message) * sizeof(pathJob));
+    if (buffer == NULL || jobs == NULL) xtermina(LINEFILE, "Allocazione dei buffer di lettura delle pipe fallita");
+
+    fprintf(stderr, "Inizio lettura da %zu named pipe.\n", opts -> numPipe);
+
+    struct epoll_event events[MAX_PIPES + 1];
+    bool running = true;
+
+    while (running) {
+        int ready = epoll_wait(epfd, events, MAX_PIPES + 1, -1);
+
+        if (ready == -1) {
+            if (errno == EINTR) continue;
+            xtermina(LINEFILE, "epoll_wait fallita durante l'attesa sulle pipe");
+        }
+
+        for (int e = 0; e < ready; e++) {
+            uint32_t index = events[e].data.u32;
+
+            if (index == MAX_PIPES) { // SIGINT
+                running = false;
+                continue;
+            }
+
+            if (!drainPipe(pool, &sources[index], buffer, jobs)) continue;
+
+            /*
+                Tutti gli scrittori hanno chiuso la pipe: il descrittore resterebbe sempre segnalato con EPOLLHUP,
+                quindi viene chiuso (epoll lo rimuove da solo) e la pipe riaperta per i prossimi scrittori.
+            */
+            close(sources[index].fd);
+            sources[index].fd = armPipe(epfd, sources[index].path, index);
+
+            fprintf(stderr, "Scrittori di %s terminati, pipe riaperta.\n", sources[index].path);
+        }
+    }
+
+    fprintf(stderr, "Inizio attesa di 20 secondi.\n");
+    sleep(20);
+    fprintf(stderr, "Fine attesa di 20 secondi.\n");
+
+    for (size_t i = 0; i < opts -> numPipe; i++) close(sources[i].fd);
+    close(epfd);
+    free(buffer);
+    free(jobs);
+}
+
+/**
+ * @brief Crea il file a.b e vi scrive il testo del buffer con una sola write().
+ * @param a Codice dell'attore iniziale.
+ * @param b Codice dell'attore destinazione.
+ * @param buffer Testo da scrivere.
+ */
+static void writeResultFile(int32_t a, int32_t b, const textBuffer* buffer) {
+    char filename[50]; // Abbondante per evitare overflow
+    sprintf(filename, "%" PRId32 ".%" PRId32, a, b);
+
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0) xtermina(LINEFILE, "Apertura del file %s fallita", filename);
+
+    size_t written = 0;
+
+    while (written < buffer -> size) {
+        ssize_t e = write(fd, buffer -> data + written, buffer -> size - written);
+
+        if (e >= 0) written += e;
+        else if (errno != EINTR) xtermina(LINEFILE, "Scrittura del file %s fallita", filename);
+    }
+
+    if (close(fd) == -1) xtermina(LINEFILE, "Chiusura del file %s fallita", filename);
+}
+
+/**
+ * @brief Formatta il testo della risposta ad una richiesta con un codice non valido.
+ * @param buffer Buffer in fondo al quale scrivere.
+ * @param invalid Codice non valido.
+ */
+void formatInvalid(textBuffer* buffer, int32_t invalid) {
+    textBufferAppendString(buffer, "Codice ");
+    textBufferAppendInt(buffer, invalid);
+    textBufferAppendString(buffer, " non valido\n");
+}
+
+/**
+ * @brief Formatta il testo della risposta ad una richiesta senza cammino.
+ * @param buffer Buffer in fondo al quale scrivere.
+ * @param a Codice dell'attore iniziale.
+ * @param b Codice dell'attore destinazione.
+ */
+void formatNoPath(textBuffer* buffer, int32_t a, int32_t b) {
+    textBufferAppendString(buffer, "Non esistono cammini da ");
+    textBufferAppendInt(buffer, a);
+    textBufferAppendString(buffer, " a ");
+    textBufferAppendInt(buffer, b);
+    textBufferAppendString(buffer, "\n");
+}
+
+/**
+ * @brief Scrive la risposta ad una richiesta con un codice non presente nel grafo, sulla pipe delle risposte o nel file a.b
+ * @param risposte Canale delle risposte (NULL per scrivere sempre il file a.b).
+ * @param buffer Buffer di testo del thread chiamante, riutilizzato tra le risposte.
+ * @param a Codice dell'attore iniziale.
+ * @param b Codice dell'attore destinazione.
+ * @param invalid Codice non valido tra a e b.
+ * @param timeStart Istante di inizio dell'elaborazione, ottenuto con times().
+ */
+void writeInvalidResult(responseChannel* risposte, textBuffer* buffer, int32_t a, int32_t b, int32_t invalid, clock_t timeStart) {
+    if (risposte == NULL || !responseSendInvalid(risposte, buffer, a, b, invalid)) {
+        textBufferClear(buffer);
+        formatInvalid(buffer, invalid);
+        writeResultFile(a, b, buffer);
+    }
+
+    printf("%" PRId32 ".%" PRId32 ": Codici invalidi. Tempo di elaborazione %.3f secondi.\n", a, b, (double)(times(NULL) - timeStart) / sysconf(_SC_CLK_TCK));
+}
+
+/**
+ * @brief Scrive il cammino minimo da a a b, sulla pipe delle risposte o nel file a.b, e stampa su stdout il riepilogo della richiesta.
+ * @details Il testo viene formattato nel buffer del thread chiamante e scritto con una sola write(), senza allocazioni.
+ * @param g Grafo degli attori.
+ * @param risposte Canale delle risposte (NULL per scrivere sempre il file a.b).
+ * @param buffer Buffer di testo del thread chiamante, riutilizzato tra le risposte.
+ * @param a Codice dell'attore iniziale.
+ * @param b Codice dell'attore destinazione.
+ * @param path Id densi dei nodi del cammino.
+ * @param length Numero di nodi del cammino, 0 se il cammino non esiste.
+ * @param timeStart Istante di inizio dell'elaborazione, ottenuto con times().
+ */
+void writePathResult(grafo* g, responseChannel* risposte, textBuffer* buffer, int32_t a, int32_t b, const int* path, size_t length, clock_t timeStart) {
+    double elapsed_time = (double)(times(NULL) - timeStart) / sysconf(_SC_CLK_TCK);
+
+    // Con un lettore connesso alla pipe delle risposte non viene creato nessun file
+    if (risposte == NULL || !responseSendPath(risposte, g, buffer, a, b, path, length)) {
+        textBufferClear(buffer);
+
+        if (length == 0) formatNoPath(buffer, a, b);
+        else formatPath(g, path, length, buffer);
+
+        writeResultFile(a, b, buffer);
+    }
+
+    printf("%" PRId32 ".%" PRId32 ": Lunghezza minima %zu. Tempo di elaborazione %.3f secondi.\n", a, b, length > 0 ? length - 1 : 0, elapsed_time);
+}
+
+/**
+ * @brief Conta i cammini minimi da a a b e ne scrive fino a maxPaths, sulla pipe delle risposte o nel file a.b.
+ * @details I cammini vengono enumerati uno alla volta direttamente nel buffer del thread, senza essere memorizzati:
+ *          se la pipe delle risposte non ha un lettore l'enumerazione riparte dal primo per il file a.b.
+ * @param g Grafo degli attori.
+ * @param risposte Canale delle risposte (NULL per scrivere sempre il file a.b).
+ * @param ctx Contesto di ricerca del thread chiamante.
+ * @param a Codice dell'attore iniziale.
+ * @param b Codice dell'attore destinazione.
+ * @param idA Id denso dell'attore iniziale.
+ * @param idB Id denso dell'attore destinazione, diverso da idA.
+ * @param filter Vincolo sugli anni di nascita dei nodi intermedi (NULL per nessun vincolo).
+ * @param maxPaths Numero massimo di cammini da scrivere.
+ * @param timeStart Istante di inizio dell'elaborazione, ottenuto con times().
+ */
+static void writeMultiPathResult(grafo* g, responseChannel* risposte, bfsContext* ctx, int32_t a, int32_t b, int idA, int idB, const yearFilter* filter, size_t maxPaths, clock_t timeStart) {
+    pathEnumerator e;
+
+    if (!bfsCountPaths(g, ctx, idA, idB, filter, maxPaths, &e)) {
+        writePathResult(g, risposte, ctx -> output, a, b, ctx -> path, 0, timeStart);
+        return;
+    }
+
+    if (risposte == NULL || !responseSendPaths(risposte, g, ctx, &e, a, b, maxPaths)) {
+        bfsRewindPaths(&e);
+        textBufferClear(ctx -> output);
+        formatPaths(g, ctx, &e, maxPaths, ctx -> output);
+        writeResultFile(a, b, ctx -> output);
+    }
+
+    printf("%" PRId32 ".%" PRId32 ": Lunghezza minima %zu, %s%" PRIu64 " cammini minimi. Tempo di elaborazione %.3f secondi.\n",
+           a, b, e.distanza, e.saturo ? "oltre " : "", e.numCammini, (double)(times(NULL) - timeStart) / sysconf(_SC_CLK_TCK));
+}
+
+/**
+ * @brief Prova a rispondere ad una richiesta con i soli landmark, in tempo O(k) più la lunghezza del cammino.
+ * @details Se un landmark raggiunge solo uno dei due nodi il cammino non esiste, se i limiti coincidono il cammino
+ *          passa per il landmark che li rende esatti.
+ * @param g Grafo degli attori.
+ * @param landmarks Indice dei landmark.
+ * @param idA Id denso del nodo iniziale.
+ * @param idB Id denso del nodo destinazione.
+ * @param path Array in cui scrivere il cammino.
+ * @param length Impostato al numero di nodi del cammino, 0 se il cammino non esiste.
+ * @return true se la richiesta ha avuto risposta, false se serve una ricerca.
+ */
+static bool landmarkAnswer(grafo* g, const landmarkIndex* landmarks, int idA, int idB, int* path, size_t* length) {
+    int lower, upper;
+    landmarkBounds(landmarks, idA, idB, &lower, &upper);
+
+    if (lower == LANDMARK_NO_PATH && !landmarks -> saturo) {
+        *length = 0;
+        return true;
+    }
+
+    fprintf(stderr, "Distanza tra %d e %d compresa tra %d e %d secondo i landmark.\n", g -> codici[idA], g -> codici[idB], lower, upper);
+
+    *length = landmarkPath(g, landmarks, idA, idB, path);
+    return *length > 0;
+}
+
+/**
+ * @brief Calcola il cammino minimo richiesto da un lavoro e lo scrive nel file a.b
+ * @param data Lavoro prelevato dalla coda del pool.
+ * @param pool Pool del worker chiamante, con il grafo, le opzioni e le cache condivise.
+ * @param ctx Contesto di ricerca del worker chiamante, riutilizzato tra le query.
+ */
+void computeShortestPath(const pathJob* data, threadPool* pool, bfsContext* ctx) {
+    grafo* g = pool -> g;
+    clock_t timeStart = times(NULL);
+
+    if (data -> idRichiesta != 0) fprintf(stderr, "Inizio calcolo per %" PRId32 " e %" PRId32 " (richiesta %" PRIu32 ").\n", data -> a, data -> b, data -> idRichiesta);
+    else fprintf(stderr, "Inizio calcolo per %" PRId32 " e %" PRId32 ".\n", data -> a, data -> b);
+
+    // Traduce i codici in id densi, il resto della ricerca lavora solo su id densi
+    int idA = nodeIndex(g, data -> a);
+
+    if (idA == -1) {
+        writeInvalidResult(pool -> risposte, ctx -> output, data -> a, data -> b, data -> a, timeStart);
+        return;
+    }
+
+    if (data -> a == data -> b) {
+        ctx -> path[0] = idA;
+        writePathResult(g, pool -> risposte, ctx -> output, data -> a, data -> b, ctx -> path, 1, timeStart);
+        return;
+    }
+
+    int idB = nodeIndex(g, data -> b);
+
+    if (idB == -1) {
+        writeInvalidResult(pool -> risposte, ctx -> output, data -> a, data -> b, data -> b, timeStart);
+        return;
+    }
+
+    // Nodi in componenti connesse diverse: il cammino non esiste, nessuna ricerca né accesso alle cache
+    if (!componentsConnected(pool -> componenti, idA, idB)) {
+        fprintf(stderr, "%" PRId32 " e %" PRId32 " appartengono a componenti connesse diverse.\n", data -> a, data -> b);
+        writePathResult(g, pool -> risposte, ctx -> output, data -> a, data -> b, ctx -> path, 0, timeStart);
+        return;
+    }
+
+    const yearFilter* filter = data -> vincolato ? &data -> vincolo : NULL;
+    if (filter != NULL) fprintf(stderr, "Nodi intermedi limitati ai nati tra il %d e il %d.\n", filter -> annoMin, filter -> annoMax);
+
+    // Più cammini minimi: le cache e i landmark danno un solo cammino per coppia, quindi serve sempre la ricerca
+    if (pool -> opts -> numCammini > 0) {
+        writeMultiPathResult(g, pool -> risposte, ctx, data -> a, data -> b, idA, idB, filter, pool -> opts -> numCammini, timeStart);
+        fprintf(stderr, "Termine calcolo per %" PRId32 " e %" PRId32 ".\n", data -> a, data -> b);
+        return;
+    }
+
+    // Richiesta con vincolo: cache e landmark descrivono il grafo completo, quindi serve sempre la ricerca e il risultato non viene memorizzato
+    if (filter != NULL) {
+        size_t pathLength = bfsConstrainedPath(g, ctx, idA, idB, filter) ? bfsExtractPath(ctx, idB) : 0;
+        writePathResult(g, pool -> risposte, ctx -> output, data -> a, data -> b, ctx -> path, pathLength, timeStart);
+        fprintf(stderr, "Termine calcolo per %" PRId32 " e %" PRId32 ".\n", data -> a, data -> b);
+        return;
+    }
+
+    // Prima cerca la coppia, in entrambi i versi, nella cache dei cammini
+    size_t pathLength;
+
+    if (pathCacheGet(pool -> cache, idA, idB, ctx -> path, &pathLength)) {
+        fprintf(stderr, "Cammino da %" PRId32 " a %" PRId32 " presente nella cache.\n", data -> a, data -> b);
+    }
+    else if (treeCacheGet(pool -> alberi, idA, idB, ctx -> path, &pathLength)) {
+        // Ricavato risalendo l'albero BFS memorizzato di uno dei due estremi
+        fprintf(stderr, "Cammino da %" PRId32 " a %" PRId32 " ricavato da un albero BFS memorizzato.\n", data -> a, data -> b);
+    }
+    else if (pool -> landmarks != NULL && landmarkAnswer(g, pool -> landmarks, idA, idB, ctx -> path, &pathLength)) {
+        fprintf(stderr, "Cammino da %" PRId32 " a %" PRId32 " ricavato dai landmark.\n", data -> a, data -> b);
+        pathCachePut(pool -> cache, idA, idB, ctx -> path, pathLength);
+    }
+    else {
+        bool found;
+
+        if (treeCacheShouldBuild(pool -> alberi, idA)) {
+            // Sorgente richiesta spesso: visita completa, l'albero servirà le prossime richieste da a
+            fprintf(stderr, "Calcolo dell'albero BFS di %" PRId32 ".\n", data -> a);
+            bfsFullTree(g, ctx, idA);
+            treeCachePut(pool -> alberi, idA, ctx);
+            found = ctx -> visited[idB] == ctx -> epoch;
+        }
+        else {
+            // Il contesto del worker (visitati con epoca, genitori e coda) viene riutilizzato, nessuna allocazione per query
+            found = findShortestPath(g, ctx, idA, idB, pool -> opts -> modalitaRicerca);
+        }
+
+        pathLength = found ? bfsExtractPath(ctx, idB) : 0;
+
+        // Anche l'assenza di un cammino viene memorizzata
+        pathCachePut(pool -> cache, idA, idB, ctx -> path, pathLength);
+    }
+
+    writePathResult(g, pool -> risposte, ctx -> output, data -> a, data -> b, ctx -> path, pathLength, timeStart);
+
+    fprintf(stderr, "Termine calcolo per %" PRId32 " e %" PRId32 ".\n", data -> a, data -> b);
+}
+
+/**
+ * @brief Formatta le informazioni di un nodo nel formato codice\tnome\tannoDiNascita\t
+ * @details Il nome viene copiato per intero, senza limiti di lunghezza.
+ * @param g Grafo degli attori.
+ * @param id Id denso del nodo.
+ * @param buffer Buffer in fondo al quale scrivere la linea.
+ */
+void formatNode(grafo* g, int id, textBuffer* buffer) {
+    textBufferAppendInt(buffer, g -> codici[id]);
+    textBufferAppend(buffer, "\t", 1);
+    textBufferAppendString(buffer, nodeName(g, id));
+    textBufferAppend(buffer, "\t", 1);
+    textBufferAppendInt(buffer, g -> anni[id]);
+    textBufferAppend(buffer, "\t\n", 2);
+}
+
+/**
+ * @brief Formatta gli attori appartenenti al cammino minimo, uno per linea nell'ordine del cammino.
+ * @param g Grafo degli attori.
+ * @param path Id densi dei nodi del cammino.
+ * @param length Numero di nodi del cammino.
+ * @param buffer Buffer in fondo al quale scrivere il cammino.
+ * @return Lunghezza del cammino (numero di archi).
+ */
+size_t formatPath(grafo* g, const int* path, size_t length, textBuffer* buffer) {
+    for (size_t i = 0; i < length; i++) formatNode(g, path[i], buffer);
+
+    return length - 1;
+}
+
+/**
+ * @brief Formatta il numero di cammini minimi e i primi maxPaths cammini, separati da una linea vuota.
+ * @param g Grafo degli attori.
+ * @param ctx Contesto dell'ultima bfsCountPaths() andata a buon fine.
+ * @param e Enumeratore dei cammini, non ancora usato.
+ * @param maxPaths Numero massimo di cammini da scrivere.
+ * @param buffer Buffer in fondo al quale scrivere.
+ * @return Numero di cammini scritti.
+ */
+size_t formatPaths(grafo* g, bfsContext* ctx, pathEnumerator* e, size_t maxPaths, textBuffer* buffer) {
+    textBufferAppendString(buffer, "Cammini minimi di lunghezza ");
+    textBufferAppendInt(buffer, e -> distanza);
+    textBufferAppendString(buffer, e -> saturo ? ": oltre " : ": ");
+
+    char count[24]; // Abbondante per un uint64_t
+    snprintf(count, sizeof(count), "%" PRIu64, e -> numCammini);
+    textBufferAppendString(buffer, count);
+    textBufferAppend(buffer, "\n", 1);
+
+    size_t written = 0, length;
+
+    while (written < maxPaths && (length = bfsNextPath(g, ctx, e)) > 0) {
+        textBufferAppend(buffer, "\n", 1);
+        formatPath(g, ctx -> path, length, buffer);
+        written++;
+    }
+
+    return written;
+}
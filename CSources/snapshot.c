@@ -0,0 +1,232 @@
+#define _GNU_SOURCE
+
+#include "../CHeaders/snapshot.h"
+#include "../CHeaders/graph.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Gli array offsets e nomiOffsets del grafo vengono usati direttamente dalla mappatura
+_Static_assert(sizeof(size_t) == sizeof(uint64_t), "Lo snapshot richiede size_t a 64 bit");
+_Static_assert(sizeof(int) == sizeof(int32_t), "Lo snapshot richiede int a 32 bit");
+
+/**
+ * @brief Arrotonda una posizione al multiplo di 8 successivo.
+ * @param pos Posizione nel file.
+ * @return Posizione allineata.
+ */
+static uint64_t align8(uint64_t pos) {
+    return (pos + 7) & ~((uint64_t) 7);
+}
+
+/**
+ * @brief Scrive una sezione dello snapshot aggiungendo il padding fino alla sua posizione.
+ * @param file File dello snapshot.
+ * @param pos Posizione corrente nel file, viene aggiornata.
+ * @param section Posizione in cui deve iniziare la sezione.
+ * @param data Dati della sezione.
+ * @param size Numero di byte della sezione.
+ */
+static void writeSection(FILE* file, uint64_t* pos, uint64_t section, const void* data, size_t size) {
+    static const char padding[8] = {0};
+
+    if (section > *pos && fwrite(padding, 1, section - *pos, file) != section - *pos) xtermina(LINEFILE, "Scrittura del padding dello snapshot fallita");
+    if (size > 0 && fwrite(data, 1, size, file) != size) xtermina(LINEFILE, "Scrittura di una sezione dello snapshot fallita");
+
+    *pos = section + size;
+}
+
+/**
+ * @brief Salva il grafo in uno snapshot binario, scrivendo su un file temporaneo che poi viene rinominato.
+ * @param g Grafo da salvare.
+ * @param path Percorso dello snapshot.
+ */
+void saveSnapshot(grafo* g, const char* path) {
+    snapshotHeader header;
+    memset(&header, 0, sizeof(header));
+
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.versione = SNAPSHOT_VERSION;
+    header.dimensioneHeader = sizeof(snapshotHeader);
+    header.numNodi = g -> numNodi;
+    header.numArchi = g -> numArchi;
+    header.dimensioneNomi = g -> dimensioneNomi;
+
+    // Calcola la posizione delle sezioni
+    header.sezioneOffsets = align8(sizeof(snapshotHeader));
+    header.sezioneVicini = align8(header.sezioneOffsets + (g -> numNodi + 1) * sizeof(uint64_t));
+    header.sezioneCodici = align8(header.sezioneVicini + g -> numArchi * sizeof(int32_t));
+    header.sezioneAnni = align8(header.sezioneCodici + g -> numNodi * sizeof(int32_t));
+    header.sezioneNomiOffsets = align8(header.sezioneAnni + g -> numNodi * sizeof(int32_t));
+    header.sezioneNomi = align8(header.sezioneNomiOffsets + (g -> numNodi + 1) * sizeof(uint64_t));
+    header.dimensioneFile = header.sezioneNomi + g -> dimensioneNomi;
+
+    char* tempPath = NULL;
+    if (asprintf(&tempPath, "%s.tmp", path) == -1) xtermina(LINEFILE, "Allocazione del percorso temporaneo dello snapshot fallita");
+
+    FILE* file = xfopen(tempPath, "wb", LINEFILE);
+    uint64_t pos = 0;
+
+    writeSection(file, &pos, 0, &header, sizeof(header));
+    writeSection(file, &pos, header.sezioneOffsets, g -> offsets, (g -> numNodi + 1) * sizeof(uint64_t));
+    writeSection(file, &pos, header.sezioneVicini, g -> vicini, g -> numArchi * sizeof(int32_t));
+    writeSection(file, &pos, header.sezioneCodici, g -> codici, g -> numNodi * sizeof(int32_t));
+    writeSection(file, &pos, header.sezioneAnni, g -> anni, g -> numNodi * sizeof(int32_t));
+    writeSection(file, &pos, header.sezioneNomiOffsets, g -> nomiOffsets, (g -> numNodi + 1) * sizeof(uint64_t));
+    writeSection(file, &pos, header.sezioneNomi, g -> nomi, g -> dimensioneNomi);
+
+    if (fclose(file) != 0) xtermina(LINEFILE, "Chiusura dello snapshot fallita");
+    if (rename(tempPath, path) == -1) xtermina(LINEFILE, "Rinomina dello snapshot %s fallita", path);
+
+    free(tempPath);
+
+    fprintf(stderr, "Snapshot del grafo salvato in %s (%llu byte).\n", path, (unsigned long long) header.dimensioneFile);
+}
+
+/**
+ * @brief Controlla che una sezione sia allineata e interamente contenuta nel file.
+ * @param header Header dello snapshot.
+ * @param section Posizione della sezione.
+ * @param count Numero di elementi della sezione.
+ * @param size Size di un elemento.
+ * @return true se la sezione è valida, false altrimenti.
+ */
+static bool validSection(const snapshotHeader* header, uint64_t section, uint64_t count, uint64_t size) {
+    if (section % 8 != 0 || section < sizeof(snapshotHeader) || section > header -> dimensioneFile) return false;
+    if (size > 0 && count > (header -> dimensioneFile - section) / size) return false;
+    return true;
+}
+
+/**
+ * @brief Controlla in O(n + m) che gli array dello snapshot descrivano un grafo CSR ben formato.
+ * @details offsets deve essere non decrescente, ogni vicino un id denso valido e codici strettamente crescente, come
+ *          richiesto dalla ricerca binaria di nodeIndex(). Ogni nome, compreso l'ultimo, deve essere non vuoto nel pool e
+ *          terminare con '\0' prima dell'inizio del successivo, dato che nodeName() lo restituisce come stringa C:
+ *          altrimenti uno snapshot corrotto, ma con header e sezioni validi, farebbe leggere la BFS e l'output fuori
+ *          dalla mappatura.
+ * @param header Header dello snapshot, con sezioni già controllate da validSection().
+ * @param base Inizio della mappatura.
+ * @return true se gli array sono coerenti, false altrimenti.
+ */
+static bool validGraph(const snapshotHeader* header, const char* base) {
+    const uint64_t* offsets = (const uint64_t*) (base + header -> sezioneOffsets);
+    const uint64_t* nomiOffsets = (const uint64_t*) (base + header -> sezioneNomiOffsets);
+    const int32_t* vicini = (const int32_t*) (base + header -> sezioneVicini);
+    const int32_t* codici = (const int32_t*) (base + header -> sezioneCodici);
+    const char* nomi = base + header -> sezioneNomi;
+
+    if (header -> numNodi > 0 && header -> dimensioneNomi == 0) return false;
+
+    for (uint64_t v = 0; v < header -> numNodi; v++) {
+        if (offsets[v] > offsets[v + 1]) return false;
+        if (nomiOffsets[v] >= nomiOffsets[v + 1] || nomiOffsets[v + 1] > header -> dimensioneNomi) return false;
+        if (nomi[nomiOffsets[v + 1] - 1] != '\0') return false;
+        if (v > 0 && codici[v - 1] >= codici[v]) return false;
+    }
+
+    for (uint64_t i = 0; i < header -> numArchi; i++) {
+        if (vicini[i] < 0 || (uint64_t) vicini[i] >= header -> numNodi) return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Mappa in sola lettura uno snapshot binario e costruisce il grafo che punta direttamente alla mappatura.
+ * @details Non viene eseguito nessun parsing: vengono controllati l'header, i limiti delle sezioni e, con una passata
+ *          sugli array, la struttura del grafo. Uno snapshot non valido fa ripiegare sui file di testo.
+ * @param path Percorso dello snapshot.
+ * @return Puntatore al grafo, NULL se lo snapshot non esiste o non è valido.
+ */
+grafo* loadSnapshot(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t) st.st_size < sizeof(snapshotHeader)) {
+        close(fd);
+        fprintf(stderr, "Snapshot %s non valido.\n", path);
+        return NULL;
+    }
+
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // La mappatura resta valida dopo la chiusura
+    if (map == MAP_FAILED) xtermina(LINEFILE, "mmap dello snapshot %s fallita", path);
+
+    const snapshotHeader* header = (const snapshotHeader*) map;
+    char* base = (char*) map;
+
+    bool valid = memcmp(header -> magic, SNAPSHOT_MAGIC, sizeof(header -> magic)) == 0
+        && header -> versione == SNAPSHOT_VERSION
+        && header -> dimensioneHeader == sizeof(snapshotHeader)
+        && header -> dimensioneFile == (uint64_t) st.st_size
+        && header -> numNodi < INT32_MAX
+        && validSection(header, header -> sezioneOffsets, header -> numNodi + 1, sizeof(uint64_t))
+        && validSection(header, header -> sezioneVicini, header -> numArchi, sizeof(int32_t))
+        && validSection(header, header -> sezioneCodici, header -> numNodi, sizeof(int32_t))
+        && validSection(header, header -> sezioneAnni, header -> numNodi, sizeof(int32_t))
+        && validSection(header, header -> sezioneNomiOffsets, header -> numNodi + 1, sizeof(uint64_t))
+        && validSection(header, header -> sezioneNomi, header -> dimensioneNomi, 1);
+
+    // Controlla la coerenza delle ultime posizioni degli array di offsets
+    if (valid) {
+        const uint64_t* offsets = (const uint64_t*) (base + header -> sezioneOffsets);
+        const uint64_t* nomiOffsets = (const uint64_t*) (base + header -> sezioneNomiOffsets);
+        valid = offsets[header -> numNodi] == header -> numArchi && nomiOffsets[header -> numNodi] == header -> dimensioneNomi
+            && validGraph(header, base);
+    }
+
+    if (!valid) {
+        fprintf(stderr, "Snapshot %s non valido o di una versione diversa.\n", path);
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    // Chiede al kernel di iniziare a leggere il file in anticipo, la BFS accede a tutto il grafo
+    madvise(map, st.st_size, MADV_WILLNEED);
+
+    grafo* g = malloc(sizeof(grafo));
+    if (g == NULL) xtermina(LINEFILE, "Allocazione del grafo fallita");
+
+    g -> attori = NULL;
+    g -> memoria = NULL;
+    g -> numNodi = header -> numNodi;
+    g -> numArchi = header -> numArchi;
+    g -> offsets = (size_t*) (base + header -> sezioneOffsets);
+    g -> vicini = (int*) (base + header -> sezioneVicini);
+    g -> codici = (int*) (base + header -> sezioneCodici);
+    g -> anni = (int*) (base + header -> sezioneAnni);
+    g -> nomiOffsets = (size_t*) (base + header -> sezioneNomiOffsets);
+    g -> nomi = base + header -> sezioneNomi;
+    g -> dimensioneNomi = header -> dimensioneNomi;
+    g -> mappa = map;
+    g -> dimensioneMappa = st.st_size;
+
+    fprintf(stderr, "Snapshot %s caricato: %zu nodi, %zu archi.\n", path, g -> numNodi, g -> numArchi);
+
+    return g;
+}
+
+/**
+ * @brief Controlla se uno snapshot esiste e non è più vecchio dei file di testo da cui è stato generato.
+ * @param path Percorso dello snapshot.
+ * @param nomiPath Percorso di nomi.txt (può essere NULL).
+ * @param grafoPath Percorso di grafo.txt (può essere NULL).
+ * @return true se lo snapshot può essere usato al posto dei file di testo, false altrimenti.
+ */
+bool snapshotIsUsable(const char* path, const char* nomiPath, const char* grafoPath) {
+    struct stat snap, text;
+
+    if (stat(path, &snap) == -1) return false;
+
+    if (nomiPath != NULL && stat(nomiPath, &text) == 0 && text.st_mtime > snap.st_mtime) return false;
+    if (grafoPath != NULL && stat(grafoPath, &text) == 0 && text.st_mtime > snap.st_mtime) return false;
+
+    return true;
+}
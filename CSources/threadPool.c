@@ -0,0 +1,161 @@
+#define _GNU_SOURCE
+
+#include "../CHeaders/threadPool.h"
+#include "../CHeaders/shortestPaths.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h> // Per PRId32
+
+/**
+ * @brief Crea il pool di thread calcolatori di cammini minimi e fa partire i worker.
+ * @details Numero di thread e capacità della coda dei lavori sono presi dalle opzioni,
+ *          ogni worker possiede un proprio contesto di ricerca riutilizzato per tutte le query.
+ * @param g Grafo degli attori.
+ * @param landmarks Indice dei landmark (NULL se disabilitato).
+ * @param componenti Componenti connesse del grafo.
+ * @param risposte Pipe delle risposte (NULL se le risposte vanno nei file a.b).
+ * @param opts Opzioni passate da linea di comando.
+ * @return Puntatore al pool creato.
+ */
+threadPool* poolCreate(grafo* g, const landmarkIndex* landmarks, const componentIndex* componenti, responseChannel* risposte, const opzioni* opts) {
+    threadPool* pool = malloc(sizeof(threadPool));
+    if (pool == NULL) xtermina(LINEFILE, "Allocazione del pool di thread fallita");
+
+    pool -> capacity = opts -> dimensioneCoda;
+    pool -> numThreads = opts -> numThread;
+    pool -> jobs = malloc(pool -> capacity * sizeof(pathJob));
+    pool -> threads = malloc(pool -> numThreads * sizeof(pthread_t));
+    if (pool -> jobs == NULL || pool -> threads == NULL) xtermina(LINEFILE, "Allocazione degli array del pool di thread fallita");
+
+    pool -> head = 0;
+    pool -> count = 0;
+    pool -> shutdown = false;
+    pool -> g = g;
+    pool -> landmarks = landmarks;
+    pool -> componenti = componenti;
+    pool -> risposte = risposte;
+    pool -> cache = pathCacheCreate(opts -> memoriaCacheCammini);
+    pool -> alberi = treeCacheCreate(opts -> numAlberi, g -> numNodi);
+    pool -> opts = opts;
+
+    xpthread_mutex_init(&pool -> mutex, NULL, LINEFILE);
+    xpthread_cond_init(&pool -> notEmpty, NULL, LINEFILE);
+    xpthread_cond_init(&pool -> notFull, NULL, LINEFILE);
+
+    for (size_t i = 0; i < pool -> numThreads; i++) {
+        xpthread_create(&pool -> threads[i], NULL, &poolWorkerBody, pool, LINEFILE);
+    }
+
+    fprintf(stderr, "Pool di %zu thread avviato, coda dei lavori di %zu elementi.\n", pool -> numThreads, pool -> capacity);
+
+    return pool;
+}
+
+/**
+ * @brief Aggiunge un lavoro alla coda del pool.
+ * @param pool Puntatore al pool.
+ * @param job Lavoro da aggiungere, viene copiato.
+ */
+void poolSubmit(threadPool* pool, const pathJob* job) {
+    poolSubmitBatch(pool, job, 1);
+}
+
+/**
+ * @brief Aggiunge un blocco di lavori alla coda del pool acquisendo il mutex una sola volta.
+ * @details Se la coda è piena il chiamante resta in attesa (backpressure): il lettore della pipe
+ *          smette di leggere e gli scrittori vengono rallentati dalla pipe piena.
+ * @param pool Puntatore al pool.
+ * @param jobs Lavori da aggiungere, vengono copiati.
+ * @param numJobs Numero di lavori.
+ */
+void poolSubmitBatch(threadPool* pool, const pathJob* jobs, size_t numJobs) {
+    xpthread_mutex_lock(&pool -> mutex, LINEFILE);
+
+    size_t i = 0;
+
+    while (i < numJobs) {
+        if (pool -> count == pool -> capacity) fprintf(stderr, "Coda dei lavori piena, lettura sospesa.\n");
+
+        while (pool -> count == pool -> capacity) xpthread_cond_wait(&pool -> notFull, &pool -> mutex, LINEFILE);
+
+        // Inserisce tutti i lavori che entrano nella coda
+        size_t added = 0;
+        while (i < numJobs && pool -> count < pool -> capacity) {
+            pool -> jobs[(pool -> head + pool -> count) % pool -> capacity] = jobs[i++];
+            pool -> count++;
+            added++;
+        }
+
+        if (added == 1) xpthread_cond_signal(&pool -> notEmpty, LINEFILE);
+        else xpthread_cond_broadcast(&pool -> notEmpty, LINEFILE);
+    }
+
+    xpthread_mutex_unlock(&pool -> mutex, LINEFILE);
+}
+
+/**
+ * @brief Funzione eseguita dai thread worker del pool.
+ * @param arg Puntatore al pool.
+ */
+void* poolWorkerBody(void* arg) {
+    threadPool* pool = (threadPool*) arg;
+
+    // Buffer di lavoro del worker, allocati una sola volta
+    bfsContext* ctx = bfsContextCreate(pool -> g -> numNodi);
+    ctx -> landmarks = pool -> landmarks;
+    pathJob job;
+
+    while (true) {
+        // Zona critica
+        xpthread_mutex_lock(&pool -> mutex, LINEFILE);
+
+        while (pool -> count == 0 && !pool -> shutdown) xpthread_cond_wait(&pool -> notEmpty, &pool -> mutex, LINEFILE);
+
+        // Termina solo dopo aver svuotato la coda
+        if (pool -> count == 0 && pool -> shutdown) {
+            xpthread_mutex_unlock(&pool -> mutex, LINEFILE);
+            break;
+        }
+
+        job = pool -> jobs[pool -> head];
+        pool -> head = (pool -> head + 1) % pool -> capacity;
+        pool -> count--;
+
+        xpthread_cond_signal(&pool -> notFull, LINEFILE);
+        xpthread_mutex_unlock(&pool -> mutex, LINEFILE);
+        // Fine zona critica
+
+        computeShortestPath(&job, pool, ctx);
+    }
+
+    bfsContextFree(ctx);
+
+    pthread_exit(NULL);
+}
+
+/**
+ * @brief Termina il pool: i worker completano i lavori ancora in coda, poi vengono attesi e la memoria deallocata.
+ * @param pool Puntatore al pool.
+ */
+void poolDestroy(threadPool* pool) {
+    xpthread_mutex_lock(&pool -> mutex, LINEFILE);
+    pool -> shutdown = true;
+    xpthread_cond_broadcast(&pool -> notEmpty, LINEFILE);
+    xpthread_mutex_unlock(&pool -> mutex, LINEFILE);
+
+    for (size_t i = 0; i < pool -> numThreads; i++) xpthread_join(pool -> threads[i], NULL, LINEFILE);
+
+    pathCachePrintStats(pool -> cache);
+    pathCacheFree(pool -> cache);
+    treeCachePrintStats(pool -> alberi);
+    treeCacheFree(pool -> alberi);
+
+    xpthread_cond_destroy(&pool -> notEmpty, LINEFILE);
+    xpthread_cond_destroy(&pool -> notFull, LINEFILE);
+    xpthread_mutex_destroy(&pool -> mutex, LINEFILE);
+    free(pool -> jobs);
+    free(pool -> threads);
+    free(pool);
+}
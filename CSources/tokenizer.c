@@ -0,0 +1,76 @@
+#define _GNU_SOURCE
+
+#include "../CHeaders/tokenizer.h"
+
+#include <string.h>
+
+/**
+ * @brief Cerca un byte in un buffer.
+ * @details Con SSE2 confronta 16 byte alla volta, altrimenti usa memchr().
+ * @param p Inizio del buffer.
+ * @param end Fine (esclusa) del buffer.
+ * @param c Byte da cercare.
+ * @return Puntatore alla prima occorrenza, end se non presente.
+ */
+const char* findByte(const char* p, const char* end, char c) {
+#if defined(__SSE2__)
+    const __m128i target = _mm_set1_epi8(c);
+
+    while (end - p >= 16) {
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) p), target));
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+
+    const char* found = (p < end) ? memchr(p, c, end - p) : NULL;
+    return found ? found : end;
+}
+
+/**
+ * @brief Conta le occorrenze di un byte in un buffer, usato per contare le linee di un file.
+ * @param p Inizio del buffer.
+ * @param end Fine (esclusa) del buffer.
+ * @param c Byte da contare.
+ * @return Numero di occorrenze.
+ */
+size_t countByte(const char* p, const char* end, char c) {
+    size_t count = 0;
+
+#if defined(__SSE2__)
+    const __m128i target = _mm_set1_epi8(c);
+
+    while (end - p >= 16) {
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) p), target)));
+        p += 16;
+    }
+#endif
+
+    while (p < end) count += (*p++ == c);
+    return count;
+}
+
+/**
+ * @brief Divide un buffer in n blocchi di circa la stessa size, ognuno esteso fino al '\n' successivo.
+ * @details Il blocco i è [starts[i], starts[i + 1]), tutti i blocchi iniziano all'inizio di una linea.
+ * @param text Inizio del buffer.
+ * @param size Size del buffer.
+ * @param n Numero di blocchi.
+ * @param starts Array di n + 1 elementi da riempire.
+ */
+void splitBlocks(const char* text, size_t size, size_t n, const char** starts) {
+    const char* end = text + size;
+    starts[0] = text;
+
+    for (size_t i = 0; i < n; i++) {
+        const char* blockEnd = (i == n - 1) ? end : text + (size / n) * (i + 1);
+
+        if (blockEnd < starts[i]) blockEnd = starts[i];
+        if (blockEnd < end) {
+            blockEnd = findByte(blockEnd, end, '\n');
+            if (blockEnd < end) blockEnd++;
+        }
+
+        starts[i + 1] = blockEnd;
+    }
+}
@@ -0,0 +1,263 @@
+#define _GNU_SOURCE
+
+#include "../CHeaders/treeCache.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief Cerca l'albero di una sorgente.
+ * @param cache Puntatore alla cache, con il mutex acquisito.
+ * @param source Id denso della sorgente.
+ * @return Puntatore allo slot dell'albero, NULL se non presente.
+ */
+static treeSlot* findTree(treeCache* cache, int source) {
+    for (size_t i = 0; i < cache -> used; i++) {
+        if (cache -> slots[i].source == source) return &(cache -> slots[i]);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Numero di richieste recenti di una sorgente, con l'invecchiamento delle ere trascorse dall'ultimo aggiornamento.
+ * @details Invece di dimezzare tutti i contatori ad ogni era, operazione O(numNodi), ogni contatore viene dimezzato
+ *          una volta per era trascorsa solo quando viene letto: il risultato è lo stesso in tempo O(1).
+ * @param cache Puntatore alla cache, con il mutex acquisito.
+ * @param source Id denso della sorgente.
+ * @return Contatore aggiornato all'era corrente.
+ */
+static uint32_t requestCount(treeCache* cache, int source) {
+    uint32_t elapsed = cache -> era - cache -> ere[source];
+
+    if (elapsed > 0) {
+        cache -> richieste[source] = elapsed < 32 ? cache -> richieste[source] >> elapsed : 0;
+        cache -> ere[source] = cache -> era;
+    }
+
+    return cache -> richieste[source];
+}
+
+/**
+ * @brief Registra una richiesta per una sorgente e fa avanzare l'era ogni TREE_CACHE_AGING_PERIOD richieste.
+ * @param cache Puntatore alla cache, con il mutex acquisito.
+ * @param source Id denso della sorgente.
+ */
+static void registerRequest(treeCache* cache, int source) {
+    if (requestCount(cache, source) < UINT32_MAX) cache -> richieste[source]++;
+
+    if (++(cache -> registrate) % TREE_CACHE_AGING_PERIOD == 0) cache -> era++;
+}
+
+/**
+ * @brief Cerca l'albero con meno richieste recenti, il primo da eliminare.
+ * @param cache Puntatore alla cache piena, con il mutex acquisito.
+ * @return Puntatore allo slot dell'albero più freddo.
+ */
+static treeSlot* coldestTree(treeCache* cache) {
+    treeSlot* coldest = &(cache -> slots[0]);
+
+    for (size_t i = 1; i < cache -> used; i++) {
+        if (requestCount(cache, cache -> slots[i].source) < requestCount(cache, coldest -> source)) coldest = &(cache -> slots[i]);
+    }
+
+    return coldest;
+}
+
+/**
+ * @brief Controlla se una sorgente merita un posto nella cache.
+ * @param cache Puntatore alla cache, con il mutex acquisito.
+ * @param source Id denso della sorgente, il cui albero non è presente.
+ * @return true se la sorgente ha almeno TREE_CACHE_THRESHOLD richieste recenti e, a cache piena, più dell'albero più freddo.
+ */
+static bool deservesSlot(treeCache* cache, int source) {
+    uint32_t count = requestCount(cache, source);
+    if (count < TREE_CACHE_THRESHOLD) return false;
+
+    return cache -> used < cache -> capacity || count > requestCount(cache, coldestTree(cache) -> source);
+}
+
+/**
+ * @brief Crea la cache degli alberi BFS delle sorgenti più richieste.
+ * @param capacity Numero massimo di alberi, 0 per disabilitare la cache.
+ * @param numNodi Numero di nodi del grafo.
+ * @return Puntatore alla cache, NULL se disabilitata.
+ */
+treeCache* treeCacheCreate(size_t capacity, size_t numNodi) {
+    if (capacity == 0) return NULL;
+
+    treeCache* cache = malloc(sizeof(treeCache));
+    if (cache == NULL) xtermina(LINEFILE, "Allocazione della cache degli alberi fallita");
+
+    cache -> slots = malloc(capacity * sizeof(treeSlot));
+    cache -> richieste = calloc(numNodi > 0 ? numNodi : 1, sizeof(uint32_t));
+    cache -> ere = calloc(numNodi > 0 ? numNodi : 1, sizeof(uint32_t));
+    if (cache -> slots == NULL || cache -> richieste == NULL || cache -> ere == NULL) xtermina(LINEFILE, "Allocazione degli array della cache degli alberi fallita");
+
+    cache -> capacity = capacity;
+    cache -> used = 0;
+    cache -> era = 0;
+    cache -> registrate = 0;
+    cache -> numNodi = numNodi;
+    cache -> hits = 0;
+    cache -> misses = 0;
+    cache -> built = 0;
+
+    xpthread_mutex_init(&cache -> mutex, NULL, LINEFILE);
+
+    return cache;
+}
+
+/**
+ * @brief Ricava il cammino minimo da a a b dall'albero di a oppure, invertito, da quello di b.
+ * @details Risale la catena dei genitori come bfsExtractPath(), in tempo proporzionale alla lunghezza del cammino.
+ * @param cache Puntatore alla cache, se NULL la ricerca fallisce sempre.
+ * @param a Id denso del nodo iniziale.
+ * @param b Id denso del nodo destinazione.
+ * @param path Array, di almeno numNodi elementi, in cui copiare il cammino da a a b.
+ * @param length Impostato al numero di nodi del cammino, 0 se il cammino non esiste.
+ * @return true se è presente l'albero di uno dei due nodi, false altrimenti.
+ */
+bool treeCacheGet(treeCache* cache, int a, int b, int* path, size_t* length) {
+    if (!cache) return false;
+
+    xpthread_mutex_lock(&cache -> mutex, LINEFILE);
+
+    // Il grafo non è orientato: va bene anche l'albero di b, risalendo da a si ottiene già il cammino da a a b
+    treeSlot* slot = findTree(cache, a);
+    bool treeOfB = false;
+
+    if (slot == NULL) {
+        slot = findTree(cache, b);
+        treeOfB = true;
+    }
+
+    if (slot == NULL) {
+        cache -> misses++;
+        xpthread_mutex_unlock(&cache -> mutex, LINEFILE);
+        return false;
+    }
+
+    // Anche le richieste servite dall'albero contano, altrimenti una sorgente memorizzata si raffredderebbe
+    cache -> hits++;
+    registerRequest(cache, slot -> source);
+
+    int from = treeOfB ? a : b;
+    size_t count = 0;
+
+    if (slot -> parents[from] != TREE_NOT_REACHED) {
+        for (int current = from; current != -1; current = slot -> parents[current]) path[count++] = current;
+    }
+
+    xpthread_mutex_unlock(&cache -> mutex, LINEFILE);
+
+    // Risalendo dall'albero di a il cammino è da b ad a
+    if (!treeOfB) {
+        for (size_t i = 0; i < count / 2; i++) {
+            int tmp = path[i];
+            path[i] = path[count - 1 - i];
+            path[count - 1 - i] = tmp;
+        }
+    }
+
+    *length = count;
+    return true;
+}
+
+/**
+ * @brief Registra una richiesta con sorgente source e decide se conviene memorizzarne l'albero.
+ * @details Una visita completa costa molto più di una ricerca bidirezionale, quindi viene eseguita solo se la sorgente
+ *          ha almeno TREE_CACHE_THRESHOLD richieste recenti e, a cache piena, più dell'albero memorizzato più freddo:
+ *          la cache contiene così gli alberi delle sorgenti più richieste invece di ricalcolarli a rotazione.
+ * @param cache Puntatore alla cache, se NULL restituisce sempre false.
+ * @param source Id denso della sorgente della richiesta.
+ * @return true se conviene calcolare e memorizzare l'albero di source.
+ */
+bool treeCacheShouldBuild(treeCache* cache, int source) {
+    if (!cache) return false;
+
+    xpthread_mutex_lock(&cache -> mutex, LINEFILE);
+
+    registerRequest(cache, source);
+    bool build = findTree(cache, source) == NULL && deservesSlot(cache, source);
+
+    xpthread_mutex_unlock(&cache -> mutex, LINEFILE);
+
+    return build;
+}
+
+/**
+ * @brief Memorizza l'albero BFS appena calcolato in un contesto, eliminando quello con meno richieste recenti se la cache è piena.
+ * @details La copia dei genitori avviene fuori dalla sezione critica, sotto mutex viene solo scambiato il puntatore.
+ *          La condizione di treeCacheShouldBuild() viene ricontrollata, dato che nel frattempo altri worker possono
+ *          aver riempito la cache.
+ * @param cache Puntatore alla cache, se NULL non fa nulla.
+ * @param source Id denso della sorgente.
+ * @param ctx Contesto in cui è appena stata eseguita bfsFullTree() da source.
+ */
+void treeCachePut(treeCache* cache, int source, bfsContext* ctx) {
+    if (!cache) return;
+
+    int* parents = malloc((cache -> numNodi > 0 ? cache -> numNodi : 1) * sizeof(int));
+    if (parents == NULL) xtermina(LINEFILE, "Allocazione di un albero della cache fallita");
+
+    for (size_t v = 0; v < cache -> numNodi; v++) {
+        parents[v] = ctx -> visited[v] == ctx -> epoch ? ctx -> parents[v] : TREE_NOT_REACHED;
+    }
+
+    int* evicted = NULL;
+
+    xpthread_mutex_lock(&cache -> mutex, LINEFILE);
+
+    // Un altro worker potrebbe aver calcolato lo stesso albero, o uno più richiesto, nel frattempo
+    if (findTree(cache, source) != NULL || !deservesSlot(cache, source)) evicted = parents;
+    else {
+        treeSlot* slot;
+
+        if (cache -> used < cache -> capacity) slot = &(cache -> slots[cache -> used++]);
+        else {
+            slot = coldestTree(cache);
+            evicted = slot -> parents;
+        }
+
+        slot -> source = source;
+        slot -> parents = parents;
+        cache -> built++;
+    }
+
+    xpthread_mutex_unlock(&cache -> mutex, LINEFILE);
+
+    free(evicted);
+}
+
+/**
+ * @brief Stampa su stderr i contatori della cache.
+ * @param cache Puntatore alla cache, se NULL non fa nulla.
+ */
+void treeCachePrintStats(treeCache* cache) {
+    if (!cache) return;
+
+    xpthread_mutex_lock(&cache -> mutex, LINEFILE);
+
+    fprintf(stderr, "Cache degli alberi: %zu hit, %zu miss, %zu alberi calcolati, %zu/%zu memorizzati.\n",
+            cache -> hits, cache -> misses, cache -> built, cache -> used, cache -> capacity);
+
+    xpthread_mutex_unlock(&cache -> mutex, LINEFILE);
+}
+
+/**
+ * @brief Dealloca la cache e tutti i suoi alberi.
+ * @param cache Puntatore alla cache.
+ */
+void treeCacheFree(treeCache* cache) {
+    if (!cache) return;
+
+    for (size_t i = 0; i < cache -> used; i++) free(cache -> slots[i].parents);
+
+    xpthread_mutex_destroy(&cache -> mutex, LINEFILE);
+    free(cache -> slots);
+    free(cache -> richieste);
+    free(cache -> ere);
+    free(cache);
+}
@@ -1,51 +1,155 @@
-#define _GNU_SOURCE
-
-#include "../CHeaders/utilities.h"
-#include "../CHeaders/xerrori.h"
-
-#include <stdlib.h>
-#include <stdio.h>
-#include <stdbool.h>
-#include <ctype.h> // Usato per isdigit()
-
-/**
- * @brief Stampa messaggio di errore durante la creazione dell'array attori e termina il programma.
- * @param msg Messaggio d'errore da stampare su stderr.
- * @param file File da chiudere.
- */
-void handleWithFileError(char* msg, FILE* file) {
-    fclose(file);
-    xtermina(LINEFILE, "%s", msg);
-}
-
-
-/**
- * @brief Funzione di controllo degli argomenti passati da linea di comando.
- * @param argc Numero di argomenti passati.
- * @param argv Array degli argomenti passati.
- * @return true se gli argomenti passati sono validi, false altrimenti.
- */
-bool validateArguments(int argc, char* argv[]) {
-    // Controllo sul numero di parametri
-    if (argc != 4) return false;
-
-    // ============================= Controllo numconsumatori =============================
-    char* n = argv[3];
-
-    // Check per empty string
-    if (n == NULL || *n == '\0') return false;
-
-    // Salto il segno
-    if (*n == '+') n++;
-
-    // Se non ci sono cifre dopo il segno non è valido
-    if (*n == '\0') return false;
-
-    // Controllo i caratteri rimanenti
-    while (*n) {
-        if (!isdigit(*n)) return false;
-        n++;
-    }
-
-    return true;
-}
+#define _GNU_SOURCE
+
+#include "../CHeaders/utilities.h"
+#include "../CHeaders/xerrori.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <ctype.h> // Usato per isdigit()
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @brief Stampa messaggio di errore durante la creazione dell'array attori e termina il programma.
+ * @param msg Messaggio d'errore da stampare su stderr.
+ * @param file File da chiudere.
+ */
+void handleWithFileError(char* msg, FILE* file) {
+    fclose(file);
+    xtermina(LINEFILE, "%s", msg);
+}
+
+
+/**
+ * @brief Mappa un file di testo in memoria in sola lettura.
+ * @param path Percorso del file.
+ * @param size Puntatore alla variabile in cui salvare la size del file.
+ * @return Puntatore alla mappatura, NULL se il file è vuoto.
+ */
+char* mapFile(const char* path, size_t* size) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) xtermina(LINEFILE, "Apertura del file %s fallita", path);
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) xtermina(LINEFILE, "fstat del file %s fallita", path);
+
+    *size = st.st_size;
+    char* text = NULL;
+
+    if (*size > 0) {
+        text = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (text == MAP_FAILED) xtermina(LINEFILE, "mmap del file %s fallita", path);
+        madvise(text, *size, MADV_SEQUENTIAL);
+    }
+
+    close(fd); // La mappatura resta valida dopo la chiusura
+    return text;
+}
+
+/**
+ * @brief Rimuove la mappatura creata da mapFile().
+ * @param text Puntatore alla mappatura (può essere NULL).
+ * @param size Size del file.
+ */
+void unmapFile(char* text, size_t size) {
+    if (text != NULL && munmap(text, size) == -1) xtermina(LINEFILE, "munmap di un file di testo fallita");
+}
+
+
+/**
+ * @brief Legge per intero un file con read(), funziona anche con named pipe e /dev/stdin che non possono essere mappati.
+ * @param path Percorso del file.
+ * @param size Puntatore alla variabile in cui salvare il numero di byte letti.
+ * @return Buffer allocato dinamicamente con il contenuto del file, da deallocare con free().
+ */
+char* readFile(const char* path, size_t* size) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) xtermina(LINEFILE, "Apertura del file %s fallita", path);
+
+    size_t capacity = 1 << 16, used = 0;
+    char* buffer = malloc(capacity);
+    if (buffer == NULL) xtermina(LINEFILE, "Allocazione del buffer di lettura di %s fallita", path);
+
+    while (true) {
+        if (used == capacity) {
+            capacity *= 2;
+            buffer = realloc(buffer, capacity);
+            if (buffer == NULL) xtermina(LINEFILE, "Riallocazione del buffer di lettura di %s fallita", path);
+        }
+
+        ssize_t readVal = read(fd, buffer + used, capacity - used);
+
+        if (readVal < 0) xtermina(LINEFILE, "Lettura del file %s fallita", path);
+        if (readVal == 0) break;
+
+        used += readVal;
+    }
+
+    close(fd);
+
+    *size = used;
+    return buffer;
+}
+
+
+/**
+ * @brief Funzione di controllo degli argomenti passati da linea di comando.
+ * @details Gli argomenti che iniziano con -- sono opzioni facoltative, gli altri sono i tre argomenti posizionali
+ *          nomi.txt, grafo.txt e numconsumatori, che possono mancare solo se viene passato --snapshot.
+ * @param argc Numero di argomenti passati.
+ * @param argv Array degli argomenti passati.
+ * @param opts Opzioni da riempire con gli argomenti passati.
+ * @return true se gli argomenti passati sono validi, false altrimenti.
+ */
+bool validateArguments(int argc, char* argv[], opzioni* opts) {
+    defaultOptions(opts);
+
+    char* positional[3];
+    int count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) == 0) {
+            if (!parseOption(argv[i], opts)) return false;
+        } else {
+            if (count == 3) return false;
+            positional[count++] = argv[i];
+        }
+    }
+
+    // Senza --pipe le richieste arrivano solo da cammini.pipe
+    if (opts -> numPipe == 0) opts -> pipes[opts -> numPipe++] = DEFAULT_PIPE;
+
+    // Avvio dal solo snapshot
+    if (count == 0) return opts -> snapshot != NULL;
+
+    // Controllo sul numero di parametri
+    if (count != 3) return false;
+
+    // ============================= Controllo numconsumatori =============================
+    char* n = positional[2];
+
+    // Check per empty string
+    if (n == NULL || *n == '\0') return false;
+
+    // Salto il segno
+    if (*n == '+') n++;
+
+    // Se non ci sono cifre dopo il segno non è valido
+    if (*n == '\0') return false;
+
+    // Controllo i caratteri rimanenti
+    while (*n) {
+        if (!isdigit(*n)) return false;
+        n++;
+    }
+
+    opts -> fileNomi = positional[0];
+    opts -> fileGrafo = positional[1];
+    opts -> numConsumatori = atoi(positional[2]);
+
+    return true;
+}